@@ -26,14 +26,24 @@ SOFTWARE.
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
+#include <coredecls.h>  //crc32()
 
 
 #include "configItems.hpp"
-#include "htmlRequests.hpp"
+#include "runtimeConfig.hpp"
+#include "HtmlRequests.hpp"
+#include "heapStats.hpp"
+#include "webAssets.hpp"
 
 extern AsyncWebServer server;
+//defined with the device mode code, lets staConfig mode pick up config changes
+void configPublishReload();
 
-bool configSaved = false;
+//Result of the last save, reported via %CONFIG_SAVED%
+String configStatus;
+//Scratch space to validate a config before it replaces devConfig.
+//Static rather than on the stack since it's fairly large for a web server callback.
+runtimeConfig pendingConfig;
 
 
 String reportFields;
@@ -42,6 +52,82 @@ String configFields;
 
 configurationItems configItems; //melm rename this once all functional code is encapsulated into this class.
 
+//Heap sampled at the start of each request. Reported via /heap.
+heapStats configHeap;
+
+bool fsMounted = true;
+//Set by a POST to /format, done by loopFormatFs()
+static bool fsFormatRequested = false;
+
+//Set for each embedded asset that has a replacement on LittleFS.
+//Checked once at startup so serving a page doesn't touch the filesystem.
+bool assetOverridden[std::size(webAssets)];
+
+#define ASSET_CACHE_CONTROL "max-age=604800"  //one week
+#define TEMPLATE_CACHE_CONTROL "no-cache"     //the values change with every form post
+
+//
+// sendAsset
+// Serve one of the web UI files. The copy embedded in flash is used unless the
+// user has put their own version on LittleFS.
+// Template pages are sent through processor(). Everything else is pre-compressed
+// and cached by the browser, since it can only change with a firmware update.
+// That's why index.htm is a static page that loads the templated fields.htm.
+//
+void sendAsset(AsyncWebServerRequest *request, const char* path) {
+  for (size_t i = 0; i < std::size(webAssets); i++) {
+    const webAsset &asset = webAssets[i];
+    if (strcmp(asset.path, path) != 0) {
+      continue;
+    }
+    AsyncWebServerResponse *response;
+    if (assetOverridden[i]) {
+      //An HTML override may be a customised copy of the old single page UI,
+      //which had the placeholders in index.htm, so it's processed regardless.
+      bool processed = asset.isTemplate || strcmp(asset.contentType, "text/html") == 0;
+      response = request->beginResponse(LittleFS, path, asset.contentType, false, processed ? processor : nullptr);
+      response->addHeader("Cache-Control", processed ? TEMPLATE_CACHE_CONTROL : ASSET_CACHE_CONTROL);
+    } else if (asset.isTemplate) {
+      response = request->beginResponse_P(200, asset.contentType, asset.data, asset.length, processor);
+      response->addHeader("Cache-Control", TEMPLATE_CACHE_CONTROL);
+    } else {
+      response = request->beginResponse_P(200, asset.contentType, asset.data, asset.length);
+      if (asset.gzipped) {
+        response->addHeader("Content-Encoding", "gzip");
+      }
+      response->addHeader("Cache-Control", ASSET_CACHE_CONTROL);
+    }
+    request->send(response);
+    return;
+  }
+  notFound(request);
+}
+
+//
+// isStockCopy
+// True if the file on LittleFS is byte for byte a page some firmware shipped,
+// e.g. the index.htm that used to be uploaded from data/. Those aren't overrides.
+//
+static bool isStockCopy(const char* path) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  uint8_t buffer[128];
+  uint32_t crc = 0xffffffff;
+  size_t length;
+  while ((length = file.read(buffer, sizeof(buffer))) > 0) {
+    crc = crc32(buffer, length, crc);
+  }
+  file.close();
+  for (const stockAssetCrc &stock : stockAssetCrcs) {
+    if (stock.crc == crc && strcmp(stock.path, path) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 //
 //    Webserver HTML template processor/callback
 //
@@ -53,9 +139,7 @@ String processor(const String& var) {
 
 
   if (var == "CONFIG_SAVED") {
-    if (configSaved) {
-      return "configuration saved";
-    }
+    return configStatus;
   }
 
 //switch to this once configs are done
@@ -65,6 +149,14 @@ String processor(const String& var) {
   if (var == "REPORT_FIELDS"){
     return reportFields;
   }
+  if (var == "FORMAT_FS") {
+    if (fsMounted) {
+      return String();
+    }
+    return F("<p>The filesystem didn't mount so the configuration can't be saved. "
+      "Formatting it erases anything left on it.</p>"
+      "<form action=\"format\" method=\"post\"><input type=\"submit\" value=\"Format filesystem\"></form>");
+  }
   //if (getItemValue(var, &item, retVal)) {
   if (configItems.getItemValue(var, retVal)) {
     return retVal;
@@ -74,28 +166,48 @@ String processor(const String& var) {
 
 void HandleConfigRequest(AsyncWebServerRequest *request) {
   Serial.println(F("request_handler"));
+  configHeap.record();
 
   // look through the config objects looking for the provided key
     //for (configItemData item : configItems) {
-  configItems.saveResponseValues(request);
+  if (!configItems.saveResponseValues(request)) {
+    configStatus = F("form data rejected");
+  }
   request->redirect("/");
 }
 
 
 void HandleSaveRequest(AsyncWebServerRequest *request) {
   Serial.println("do save stuff here");
+  configHeap.record();
+  String configError;
   configItems.dumpToJson(jsonConfig);
   if (configItems.isEmpty() || jsonConfig.isNull()) {
     eraseConfig(CONFIG_FILE);
+    clearRuntimeConfig(devConfig);
+    configStatus = F("configuration erased");
+    configPublishReload();
+  } else if (!decodeRuntimeConfig(jsonConfig, pendingConfig, configError)) {
+    //don't save a config the device can't use
+    Serial.print(F("config rejected: "));
+    Serial.println(configError);
+    configStatus = String(F("configuration not saved: ")) + configError;
+  } else if (!saveConfigFile(CONFIG_FILE)) {
+    configStatus = F("configuration not saved: filesystem error");
   } else {
-    configItems.dumpToJson(jsonConfig);
-    saveConfigFile(CONFIG_FILE);
+    devConfig = pendingConfig;
+    configStatus = F("configuration saved");
+    configPublishReload();
   }
-  request->send(LittleFS, "/index.htm", "text/html", false, processor);
+  //configItems holds the values from here on
+  releaseConfigJson();
+  //the page picks up configStatus from fields.htm, and a reload won't post again
+  request->redirect("/");
 }
 
 void HandleRebootRequest (AsyncWebServerRequest *request) {
   Serial.println(F("rebooting..."));
+  configHeap.record();
   request->send(200, "text/plain", "Rebooting...");
   ESP.restart();
 }
@@ -104,21 +216,64 @@ void HandleClearRequest (AsyncWebServerRequest *request) {
   //no data, we just go ahead and delete the config file
   //TODO: Move to config object
   Serial.print(F("Deleting config"));
+  configHeap.record();
   //TODO check return status
   //devConfig.clearConfig();
   jsonConfig.clear();
   configItems.clearValues();
   //eraseConfig(CONFIG_FILE);
-  request->send(LittleFS, "/index.htm", "text/html", false, processor);
+  request->redirect("/");
 }
 
+//
+// HandleFormatRequest
+// Format LittleFS after it failed to mount. That takes seconds, which is too
+// long for a web server callback, so it's left to loopFormatFs().
+// A filesystem that mounted is never formatted from here.
+//
+void HandleFormatRequest(AsyncWebServerRequest *request) {
+  configHeap.record();
+  if (!fsMounted) {
+    fsFormatRequested = true;
+    configStatus = F("formatting the filesystem, reload the page in a few seconds");
+  }
+  request->redirect("/");
+}
+
+//
+// loopFormatFs
+// Run from loop() while there's no filesystem. Formats and mounts it once requested.
+//
+void loopFormatFs() {
+  if (!fsFormatRequested) {
+    return;
+  }
+  fsFormatRequested = false;
+  Serial.println(F("Formatting LittleFS"));
+  fsMounted = LittleFS.format() && LittleFS.begin();
+  if (fsMounted) {
+    configStatus = F("filesystem formatted, the configuration can be saved now");
+  } else {
+    configStatus = F("filesystem format failed");
+  }
+  Serial.println(configStatus);
+}
 
 void notFound(AsyncWebServerRequest *request) {
+  configHeap.record();
 
   //Serial.print(request);
   request->send(404, "text/plain", "Not found");
 }
 
+//
+// Report the heap telemetry. The sample taken for this request is included.
+//
+void HandleHeapRequest(AsyncWebServerRequest *request) {
+  configHeap.record();
+  request->send(200, "application/json", configHeap.toJson());
+}
+
 
 //rename this as HTML startup. Instantiate the config objects here and build the HTML that needs to be output
 void registerHtmlInterfaces()
@@ -127,17 +282,41 @@ void registerHtmlInterfaces()
   //String tempStr2 = new String;
   Serial.println(F("registerHtmlInterfaces"));
   server.on("/", HTTP_GET, [](AsyncWebServerRequest * request) {
-    //request->send_P(200, "text/html", index_html, processor);
-    request->send(LittleFS, "/index.htm", "text/html", false, processor);
+    configHeap.record();
+    sendAsset(request, "/index.htm");
   });
+  for (size_t i = 0; i < std::size(webAssets); i++) {
+    const char* path = webAssets[i].path;
+    //LittleFS.exists() is false if the FS didn't mount, which leaves the embedded copy in use
+    if (LittleFS.exists(path) && isStockCopy(path)) {
+      //a stock page would hide the embedded one, which is at least as new
+      LittleFS.remove(path);
+      Serial.print(F("removed stock LittleFS copy of "));
+      Serial.println(path);
+    }
+    assetOverridden[i] = LittleFS.exists(path);
+    if (assetOverridden[i]) {
+      Serial.print(F("using LittleFS copy of "));
+      Serial.println(path);
+    }
+    server.on(path, HTTP_GET, [path](AsyncWebServerRequest * request) {
+      configHeap.record();
+      sendAsset(request, path);
+    });
+  }
   server.on("/config", HTTP_POST, HandleConfigRequest);
   server.on("/save", HTTP_POST, HandleSaveRequest);
   server.on("/reset", HTTP_POST, HandleClearRequest);
   server.on("/reboot", HTTP_POST, HandleRebootRequest);
+  server.on("/heap", HTTP_GET, HandleHeapRequest);
+  server.on("/format", HTTP_POST, HandleFormatRequest);
   server.onNotFound(notFound);
 
   //Init the config class
-  configItems.LoadValues(jsonConfig);
+  if (!configItems.LoadValues(jsonConfig)) {
+    Serial.println(F("config file has unknown keys, they will be dropped on the next save"));
+  }
+  releaseConfigJson();
   //build up our strings for the templates
   //they won't change so only do this once.
   configItems.buildInputFormEntries(configFields);
@@ -147,5 +326,8 @@ void registerHtmlInterfaces()
   Serial.println();
   Serial.println(F("Report fields:"));
   Serial.println(reportFields);
+  const heapSample &heap = configHeap.record();
+  Serial.printf("heap after building templates: free %u max block %u frag %u%%\r\n",
+    heap.freeHeap, heap.maxFreeBlock, heap.fragmentation);
 
 }
\ No newline at end of file
@@ -29,11 +29,18 @@ SOFTWARE.
 #include <ESPAsyncWebServer.h>
 
 String processor(const String& var);
+void sendAsset(AsyncWebServerRequest *request, const char* path);
 void HandleConfigRequest(AsyncWebServerRequest *request);
 void HandleSaveRequest(AsyncWebServerRequest *request);
 void HandleRebootRequest (AsyncWebServerRequest *request);
 void HandleClearRequest (AsyncWebServerRequest *request);
 void notFound(AsyncWebServerRequest *request);
+void HandleHeapRequest(AsyncWebServerRequest *request);
+void HandleFormatRequest(AsyncWebServerRequest *request);
+void loopFormatFs();
 void registerHtmlInterfaces();
 
+//false if LittleFS didn't mount, which puts a format button on the config page
+extern bool fsMounted;
+
 #endif
\ No newline at end of file
@@ -40,6 +40,7 @@ struct configItemData {
 bool loadConfigFile(String configFileLoc);
 bool saveConfigFile(String configFileLoc);
 bool eraseConfig(String configFileLoc);
+void releaseConfigJson();
 
 
 //class configurationItems: encapsulation of the config items.
@@ -52,18 +53,30 @@ bool eraseConfig(String configFileLoc);
 class configurationItems {
 
 public:
+  configurationItems() = default;
+
+  //
+  // Use a different set of items. The host benchmarks use this to see how the
+  // pages scale with the number of items.
+  //
+  explicit configurationItems(std::vector<configItemData> items) : configItems(std::move(items)) {}
+
 //
 // LoadValues
 // Take values from JSON configuration data and load it to the value field
 // of the config item with a matching key.
-// Currenty, no error is generated if a key is defined in the config data 
-// but is not in the JSON data.
+// No error is generated if a key is defined in the config data 
+// but is not in the JSON data since that is how new items get added.
+// Keys in the JSON data that don't match a config item are reported and dropped.
 //
 // Note for the future is that this should indicate an issue with the config 
 // and recovery action should be to erase the file then bring the device back 
 // up as unconfigured.
+//
+// Returns false if the JSON data had keys that aren't config items.
 // 
-  void LoadValues(JsonDocument &jsonConfig) {
+  bool LoadValues(JsonDocument &jsonConfig) {
+    bool allKeysKnown = true;
     Serial.println(F("Load config values"));
     //load up the JSON file and prepare to save it.
     for (int i = 0; i < std::size(configItems); i++) {
@@ -83,7 +96,14 @@ public:
       }
       Serial.println(F("\"]"));
     }
-    return;
+    for (JsonPair item : jsonConfig.as<JsonObject>()) {
+      if (findItem(item.key().c_str()) < 0) {
+        Serial.print(F("unknown config key: "));
+        Serial.println(item.key().c_str());
+        allKeysKnown = false;
+      }
+    }
+    return allKeysKnown;
   }
 
   //
@@ -157,25 +177,44 @@ public:
 //    Since the form data  *should* have been build by this class, the response 
 //    data should also match the config data.
 //
-// TODO: Error checking on the response data. A mismatch should be considered to 
-//    indicate a possible attack and the data ignored.
+// A mismatch (a field that isn't a config item, or a value longer than the 
+// form allows) means either a communications issue or an attack on the interface,
+// so the whole submission is ignored.
 //
-  void saveResponseValues (AsyncWebServerRequest *request) {
+// Returns false if the submission was ignored.
+//
+  bool saveResponseValues (AsyncWebServerRequest *request) {
+    //check everything before changing anything
+    for (size_t p = 0; p < request->params(); p++) {
+      const AsyncWebParameter* param = request->getParam(p);
+      if (!param->isPost()) {
+        continue;
+      }
+      int i = findItem(param->name());
+      if (i < 0) {
+        Serial.print(F("unexpected form field: "));
+        Serial.println(param->name());
+        return false;
+      }
+      //the form's maxlength allows exactly maxLength characters
+      if (param->value().length() > static_cast<unsigned int>(configItems[i].maxLength)) {
+        Serial.print(F("value too long: "));
+        Serial.println(param->name());
+        return false;
+      }
+    }
     for (int i = 0; i < configItems.size(); i++) {
-        //TODO: Figure out what to do with an item that isn't handled.
-        //If that happens, the implication is either a communications issue or an attack on the interface.
       if (request->hasParam(configItems[i].key, true)) {
         Serial.println(configItems[i].key);
-        if (request->getParam(configItems[i].key, true)->value().length() < configItems[i].maxLength &&
-            request->getParam(configItems[i].key, true)->value().length() > 0 ){ 
-          //only update if a value is below the max length and 
-          //if data was actually sent. Clearing data is the function of the clear button.
+        if (request->getParam(configItems[i].key, true)->value().length() > 0 ){ 
+          //only update if data was actually sent. Clearing data is the function of the clear button.
           configItems[i].value = request->getParam(configItems[i].key, true)->value();
           continue;
         }
       }
     }
     configEmpty = false;
+    return true;
   }
 
   //
@@ -185,7 +224,7 @@ public:
   //
   // 1) Check the template variable provided by the webserver against the provided configuration item.
   // 2) If the item is a match, check if the item is protected.
-  // 3) If it is not protected, set a reference to the stored value string.
+  // 3) If it is not protected, set a reference to the stored value string, escaped for the page.
   // 4) If it is protected, check if there is a stored value.
   // 5) If it is not emply, set a reference to a dummy string.
   // 6) Return true if the reference was updated, false if the refernece isn't 'valid'.
@@ -206,7 +245,8 @@ public:
         //now see if we return the value string or a dummy
         if (!configItems[i].protect_pw) {
           Serial.println(configItems[i].value);
-          valueString = configItems[i].value;
+          valueString = String();
+          appendHtmlEscaped(valueString, configItems[i].value);
           return true;
         } else {
           if (configItems[i].value.length() > 0) {
@@ -220,6 +260,27 @@ public:
     return false;
   }
 
+//
+// appendHtmlEscaped
+// Values end up in attributes and table cells of the page, and the web server
+// scans whatever the processor returns for more %placeholders%. Escape
+// anything that would be taken as markup or as the start of a placeholder.
+//
+  static void appendHtmlEscaped(String &buffer, const String &text) {
+    buffer.reserve(buffer.length() + text.length());
+    for (unsigned int i = 0; i < text.length(); i++) {
+      switch (text[i]) {
+        case '&': buffer += F("&amp;"); break;
+        case '<': buffer += F("&lt;"); break;
+        case '>': buffer += F("&gt;"); break;
+        case '"': buffer += F("&quot;"); break;
+        case '\'': buffer += F("&#39;"); break;
+        case '%': buffer += F("&#37;"); break;
+        default: buffer += text[i]; break;
+      }
+    }
+  }
+
 //
 // clearValues
 // Trivial method to remove all value data from each of the config items
@@ -251,6 +312,19 @@ public:
     return configEmpty;
   }
 
+//
+// findItem
+// Returns the index of the config item with the given key, -1 if there isn't one.
+//
+  int findItem(const String &key) {
+    for (int i = 0; i < configItems.size(); i++) {
+      if (key == configItems[i].key) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
 
 //
 // Configuration data. Placed at the very end of this file in an effort 
@@ -277,9 +351,15 @@ private:
         64
     },
     {
-      "MQTT server IP",
+      "MQTT brokers, ip[:port] comma separated",
         "MqttIp",
         false,
+        128
+    },
+    {
+      "MQTT TLS cert SHA1 fingerprint (blank for no TLS)",
+        "MqttTlsFingerprint",
+        false,
         64
     },
     {
@@ -305,6 +385,42 @@ private:
         "MqttHumTopic",
         false,
         128
+    },
+    {
+      "HA discovery prefix (blank to disable)",
+        "MqttDiscoveryPrefix",
+        false,
+        64
+    },
+    {
+      "NTP server (blank for pool.ntp.org)",
+        "NtpServer",
+        false,
+        64
+    },
+    {
+      "Sample rate Hz, 1-10 (blank for deep sleep)",
+        "SampleRateHz",
+        false,
+        4
+    },
+    {
+      "Sample window seconds",
+        "WindowSeconds",
+        false,
+        8
+    },
+    {
+      "Stream raw samples (yes/no)",
+        "RawStream",
+        false,
+        8
+    },
+    {
+      "Publish samples as JSON with a timestamp (yes/no)",
+        "TimestampPayloads",
+        false,
+        8
     }
   };
 };
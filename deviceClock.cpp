@@ -0,0 +1,224 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <Arduino.h>
+#include <include/WiFiState.h>
+#include <RTCMemory.h>
+#include <coredecls.h>  //settimeofday_cb()
+#include <sys/time.h>
+#include <time.h>
+
+#include "runtimeConfig.hpp"
+#include "rtcInterface.hpp"
+#include "deviceClock.hpp"
+
+//
+// Wall clock for the deep sleep cycle.
+// Syncing with SNTP on every wake would keep the radio up longer, so the time is
+// carried across deep sleep in RTC RAM instead: the estimated time at the start
+// of the sleep plus the requested sleep length. The deep sleep timer runs several
+// percent off, so the sleep length is corrected by a drift factor learned from the
+// error seen at each sync. The fixed boot time before millis() starts counting is
+// folded into the same factor, which works since every wake sleeps the same time.
+// Once the estimate is made it's loaded into the system clock so the rest of
+// the code can just use gettimeofday().
+//
+#define MIN_VALID_EPOCH 1700000000UL     //anything earlier means the clock was never set
+#define SNTP_TIMEOUT_MILLS 2000
+#define MIN_LEARNING_SLEEP_MICROS 600e6  //need at least ten minutes of sleep to learn from
+#define MAX_DRIFT_PPM 100000             //10%
+
+static volatile bool sntpSynced = false;
+static bool clockValid = false;
+
+static void onTimeSet(bool fromSntp) {
+  if (fromSntp) {
+    sntpSynced = true;
+  }
+}
+
+static void setClock(uint64_t epochMillis) {
+  struct timeval tv;
+  tv.tv_sec = epochMillis / 1000;
+  tv.tv_usec = (epochMillis % 1000) * 1000;
+  settimeofday(&tv, nullptr);
+  clockValid = true;
+}
+
+//
+// clockNowMillis
+// Current wall time in milliseconds since the epoch, 0 if it isn't known yet.
+//
+uint64_t clockNowMillis() {
+  struct timeval tv;
+  if (!clockValid && !sntpSynced) {
+    return 0;
+  }
+  gettimeofday(&tv, nullptr);
+  if (static_cast<uint32_t>(tv.tv_sec) < MIN_VALID_EPOCH) {
+    return 0;
+  }
+  return static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+//
+// clockOnWake
+// Work out the current time from the time the sleep started and how long it should have lasted.
+// RTC RAM survives other resets too (reset button, watchdog, crash), and after
+// those the carried time has nothing to do with how long the device was off.
+// Only a deep sleep wake uses it; anything else drops it until the next sync.
+// The drift factor belongs to the hardware so it's kept either way.
+//
+void clockOnWake(devRtcData* data) {
+  if (data == nullptr) {
+    Serial.println(F("clock: no time carried over"));
+    return;
+  }
+  if (ESP.getResetInfoPtr()->reason != REASON_DEEP_SLEEP_AWAKE) {
+    Serial.printf("clock: reset reason %u, not using the carried time\r\n",
+      static_cast<unsigned int>(ESP.getResetInfoPtr()->reason));
+    data->clock.epochMillisAtSleep = 0;
+    data->clock.synced = false;
+    data->clock.sleepMicrosSinceSync = 0;
+    data->clock.wakesSinceSync = 0;
+    return;
+  }
+  if (data->clock.epochMillisAtSleep == 0) {
+    Serial.println(F("clock: no time carried over"));
+    return;
+  }
+  int64_t sleptMicros = static_cast<int64_t>(data->clock.sleepMicros) +
+    static_cast<int64_t>(data->clock.sleepMicros) * data->clock.driftPpm / 1000000;
+  setClock(data->clock.epochMillisAtSleep + sleptMicros / 1000 + millis());
+}
+
+//
+// syncWithSntp
+// Blocking SNTP sync with a short timeout. Returns false if it didn't complete.
+//
+static bool syncWithSntp() {
+  settimeofday_cb(onTimeSet);
+  sntpSynced = false;
+  configTime(0, 0, devConfig.ntpServer[0] != 0 ? devConfig.ntpServer : DEFAULT_NTP_SERVER);
+  unsigned long startMillis = millis();
+  while (!sntpSynced) {
+    if (millis() - startMillis > SNTP_TIMEOUT_MILLS) {
+      Serial.println(F("clock: SNTP timeout"));
+      return false;
+    }
+    delay(10);
+  }
+  clockValid = true;
+  return true;
+}
+
+//
+// clockSyncIfDue
+// Called once WiFi is up. Only syncs every CLOCK_SYNC_WAKES wakes, or if the time is unknown.
+// Each sync compares the carried time with the real time and updates the drift factor.
+// Nothing a wake publishes needs the time without TimestampPayloads, so then
+// it doesn't sync at all rather than keep the radio up for it.
+//
+void clockSyncIfDue(devRtcData* data) {
+  if (!devConfig.timestampPayloads) {
+    return;
+  }
+  bool haveEstimate = clockNowMillis() != 0;
+  if (haveEstimate && data != nullptr && data->clock.wakesSinceSync < CLOCK_SYNC_WAKES) {
+    return;
+  }
+  uint64_t estimateMillis = clockNowMillis();
+  unsigned long startMillis = millis();
+  if (!syncWithSntp()) {
+    return;
+  }
+  if (data == nullptr) {
+    return;
+  }
+  if (haveEstimate && data->clock.synced && data->clock.sleepMicrosSinceSync >= MIN_LEARNING_SLEEP_MICROS) {
+    //error between the real time and the estimate, in microseconds
+    int64_t errorMicros = (static_cast<int64_t>(clockNowMillis()) -
+      static_cast<int64_t>(estimateMillis + (millis() - startMillis))) * 1000;
+    int32_t residualPpm = errorMicros * 1000000 / static_cast<int64_t>(data->clock.sleepMicrosSinceSync);
+    //only move halfway to damp out noise from the sync itself
+    int32_t driftPpm = data->clock.driftPpm + residualPpm / 2;
+    data->clock.driftPpm = constrain(driftPpm, -MAX_DRIFT_PPM, MAX_DRIFT_PPM);
+    Serial.printf("clock: error %ld ms over %lu s of sleep, drift now %ld ppm\r\n",
+      static_cast<long>(errorMicros / 1000), static_cast<unsigned long>(data->clock.sleepMicrosSinceSync / 1000000),
+      static_cast<long>(data->clock.driftPpm));
+  }
+  data->clock.synced = true;
+  data->clock.sleepMicrosSinceSync = 0;
+  data->clock.wakesSinceSync = 0;
+}
+
+//
+// clockBeforeSleep
+// Record what's needed to carry the time across the sleep. The caller saves the RTC data.
+//
+void clockBeforeSleep(devRtcData* data, uint64_t sleepMicros) {
+  if (data == nullptr) {
+    return;
+  }
+  data->clock.epochMillisAtSleep = clockNowMillis();
+  data->clock.sleepMicros = sleepMicros;
+  data->clock.sleepMicrosSinceSync += sleepMicros;
+  data->clock.wakesSinceSync++;
+}
+
+//
+// clockStartSntp
+// For the modes that stay awake. SNTP keeps the system clock in sync by itself.
+//
+void clockStartSntp() {
+  settimeofday_cb(onTimeSet);
+  configTime(0, 0, devConfig.ntpServer[0] != 0 ? devConfig.ntpServer : DEFAULT_NTP_SERVER);
+}
+
+//
+// formatEpochMillis
+// uint64_t doesn't print reliably on all cores, so print seconds and milliseconds separately.
+//
+String formatEpochMillis(uint64_t epochMillis) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%lu%03u", static_cast<unsigned long>(epochMillis / 1000),
+    static_cast<unsigned int>(epochMillis % 1000));
+  return String(buffer);
+}
+
+//
+// timestampedValue
+// Payload for a sample. That's the plain value, which is what existing
+// subscribers expect, unless TimestampPayloads is set in the config. Then it's
+// {"value":<value>,"ts":<epoch millis>}, with the timestamp left out if the
+// time isn't known.
+//
+String timestampedValue(const String &value, uint64_t timestampMillis) {
+  if (!devConfig.timestampPayloads) {
+    return value;
+  }
+  if (timestampMillis == 0) {
+    return String("{\"value\":") + value + "}";
+  }
+  return String("{\"value\":") + value + ",\"ts\":" + formatEpochMillis(timestampMillis) + "}";
+}
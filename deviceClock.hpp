@@ -0,0 +1,41 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef DEVICE_CLOCK_H_
+#define DEVICE_CLOCK_H_
+
+#include "rtcInterface.hpp"
+
+//Sync with SNTP every this many wakes. Hourly with the one minute sleep.
+#define CLOCK_SYNC_WAKES 60
+#define DEFAULT_NTP_SERVER "pool.ntp.org"
+
+void clockOnWake(devRtcData* data);
+void clockSyncIfDue(devRtcData* data);
+void clockBeforeSleep(devRtcData* data, uint64_t sleepMicros);
+void clockStartSntp();
+uint64_t clockNowMillis();
+String timestampedValue(const String &value, uint64_t timestampMillis);
+String formatEpochMillis(uint64_t epochMillis);
+
+#endif
@@ -26,6 +26,8 @@ SOFTWARE.
 #include <ESPAsyncWebServer.h>  //needed by configItems.hpp
 
 #include <AsyncMqttClient.h>  //consider AsyncMQTT_Generic which is based on this.
+#include <WiFiClientSecureBearSSL.h>
+#include <PubSubClient.h>
 #include <include/WiFiState.h>
 #include <RTCMemory.h>
 
@@ -34,7 +36,10 @@ SOFTWARE.
 //#include <AsyncMqttClient.h>
 
 #include "configItems.hpp"
+#include "runtimeConfig.hpp"
 #include "rtcInterface.hpp"
+#include "mqttDiscovery.hpp"
+#include "deviceClock.hpp"
 
 //
 // defines that simply make times easier to use
@@ -42,6 +47,8 @@ SOFTWARE.
 #define FIVE_SECONDS_IN_MILLS 5000
 #define TEN_SECONDS_IN_MILLS 10000
 #define THIRTY_SECONDS_IN_MILLS 30000
+#define THREE_SECONDS_IN_MILLS 3000
+#define ONE_MINUTE_IN_MILLS 60000
 
 #define TEN_SECONDS_IN_MICRO 10e6
 #define THIRTY_SECONDS_IN_MICRO 30e6
@@ -54,6 +61,42 @@ SOFTWARE.
 
 AsyncMqttClient mqttClient;
 //
+// TLS connections.
+// AsyncMqttClient's TLS support depends on axTLS through ESPAsyncTCP, which has
+// no way to resume a session. So when TLS is configured, a BearSSL client is used
+// with PubSubClient on top of it. The BearSSL session is kept in RTC RAM so the
+// next wake can do an abbreviated handshake rather than a full one.
+// The mqtt* wrappers below hide which client is in use.
+//
+#define MQTT_TLS_BUFFER_SIZE 768  //large enough for the discovery documents
+//BearSSL's buffers default to a full 16KB record for receiving, about 17KB
+//between them. A broker that supports the max fragment length extension can
+//be asked for 512 byte records instead. Sending never needs more than that
+//since BearSSL splits what it sends into records of the buffer size.
+#define TLS_MFLN_SIZE 512
+#define TLS_DEFAULT_RX_SIZE 16384
+
+BearSSL::WiFiClientSecure tlsClient;
+PubSubClient tlsMqtt(tlsClient);
+BearSSL::Session tlsSession;
+bool mqttUseTls = false;  //copy of devConfig.useTls as of the last mqttApplyConfig()
+bool tlsFingerprintSet = false;  //BearSSL can't verify the broker without one
+
+//
+// MQTT broker failover.
+// Brokers are tried starting with the one that worked last, then in order of
+// their health score. A success raises a broker's score and a failure drops it
+// twice as fast, so a broker that keeps failing sinks to the end of the list
+// while one that only hiccups doesn't. The state lives in RTC RAM so each wake
+// starts with the broker most likely to work.
+//
+#define BROKER_ATTEMPT_MILLS THREE_SECONDS_IN_MILLS
+#define BROKER_HEALTH_MAX 4
+#define BROKER_HEALTH_MIN -8
+
+brokerFailoverState fallbackBrokerState;  //used if RTC RAM isn't available
+int currentBroker = 0;           //index into devConfig.brokers
+//
 // Sensor specific definitions
 //
 #define SHT31_ADDRESS 0x44
@@ -62,6 +105,7 @@ SHT31 sht;
 int topicsPublished = 0;
 int topicsToPublish = 0;
 unsigned long loopMillis;
+uint32_t pendingDiscoveryHash = 0; //non-zero if discovery was sent this wake
 
 //
 // This is used to help indicate when it is safe to go to deep sleep and end the sleep-wake cycle.
@@ -70,9 +114,186 @@ void onMqttPublish(uint16_t packetId) {
   topicsPublished++;
 }
 
+static String mqttClientId() {
+  if (devConfig.hostname[0] != 0) {
+    return String(devConfig.hostname);
+  }
+  return String("esp8266-") + String(ESP.getChipId(), HEX);
+}
+
+//
+// failoverState
+// Get the failover state, resetting it if the broker list has changed.
+//
+static brokerFailoverState* failoverState() {
+  devRtcData* rtcData = rtcMemIface.getData();
+  brokerFailoverState* data = rtcData != nullptr ? &rtcData->brokerState : &fallbackBrokerState;
+  if (data->brokerListHash != devConfig.brokerListHash) {
+    data->brokerListHash = devConfig.brokerListHash;
+    data->lastGoodBroker = 0;
+    memset(data->brokerHealth, 0, sizeof(data->brokerHealth));
+    data->mflnProbed = 0;
+    data->mflnSupported = 0;
+  }
+  return data;
+}
+
+//
+// tlsMqttConnect
+// Connect over TLS, offering the session saved in RTC RAM if there is one.
+// A server that doesn't recognize the session just does a full handshake, so
+// a stale session only costs the time it would have taken anyway.
+// The handshake time is logged and kept in RTC RAM to compare full and resumed handshakes.
+//
+static bool tlsMqttConnect() {
+  devRtcData* data = rtcMemIface.getData();
+  bool resuming = data != nullptr && data->tlsSessionValid;
+  brokerFailoverState* brokerState = failoverState();
+  uint8_t brokerBit = 1 << currentBroker;
+
+  if (!tlsFingerprintSet) {
+    Serial.println(F("TLS MQTT: no fingerprint to verify the broker with, not connecting"));
+    return false;
+  }
+  if (resuming) {
+    memcpy(reinterpret_cast<void*>(&tlsSession), data->tlsSession, sizeof(tlsSession));
+  }
+  //The probe is its own connection so it's only done until one works. A
+  //probe that fails because the broker is down isn't taken as the answer.
+  if ((brokerState->mflnProbed & brokerBit) == 0) {
+    const mqttBroker &endpoint = devConfig.brokers[currentBroker];
+    if (BearSSL::WiFiClientSecure::probeMaxFragmentLength(endpoint.ip, endpoint.port, TLS_MFLN_SIZE)) {
+      brokerState->mflnSupported |= brokerBit;
+    } else {
+      brokerState->mflnSupported &= ~brokerBit;
+    }
+  }
+  bool smallRecords = (brokerState->mflnSupported & brokerBit) != 0;
+  tlsClient.setBufferSizes(smallRecords ? TLS_MFLN_SIZE : TLS_DEFAULT_RX_SIZE, TLS_MFLN_SIZE);
+
+  unsigned long startMillis = millis();
+  bool connected = tlsMqtt.connect(mqttClientId().c_str(),
+    devConfig.mqttUser[0] != 0 ? devConfig.mqttUser : nullptr, devConfig.mqttPw[0] != 0 ? devConfig.mqttPw : nullptr);
+  unsigned long elapsedMillis = millis() - startMillis;
+  Serial.printf("TLS MQTT connect %s in %lu millis (%s, %d byte records)\r\n", connected ? "ok" : "failed",
+    elapsedMillis, resuming ? "resume offered" : "full handshake", smallRecords ? TLS_MFLN_SIZE : TLS_DEFAULT_RX_SIZE);
+  if (connected) {
+    brokerState->mflnProbed |= brokerBit;
+  } else {
+    //a fingerprint mismatch shows up here rather than as an MQTT error
+    char sslError[64];
+    int sslErrorCode = tlsClient.getLastSSLError(sslError, sizeof(sslError));
+    if (sslErrorCode != 0) {
+      Serial.printf("TLS error %d: %s\r\n", sslErrorCode, sslError);
+    }
+  }
+  if (data != nullptr) {
+    data->tlsConnectMillis = elapsedMillis;
+    data->tlsSessionValid = connected;
+    if (connected) {
+      memcpy(data->tlsSession, reinterpret_cast<const void*>(&tlsSession), sizeof(tlsSession));
+    }
+  }
+  return connected;
+}
+
+bool mqttConnected() {
+  return mqttUseTls ? tlsMqtt.connected() : mqttClient.connected();
+}
+
+//
+// mqttPublish
+// PubSubClient only does QoS 0 and writes straight to the socket, so a
+// successful write is counted as acknowledged.
+//
+void mqttPublish(const char* topic, uint8_t qos, bool retain, const char* payload) {
+  if (topic == nullptr || topic[0] == 0) {
+    return;
+  }
+  if (mqttUseTls) {
+    if (tlsMqtt.publish(topic, payload, retain)) {
+      topicsPublished++;
+    }
+  } else {
+    mqttClient.publish(topic, qos, retain, payload);
+  }
+}
+
+void mqttDisconnect(bool force) {
+  if (mqttUseTls) {
+    tlsMqtt.disconnect();
+  } else {
+    mqttClient.disconnect(force);
+  }
+}
+
+//
+// brokerOrder
+// Fill order[] with broker indexes in the order they should be tried.
+// Returns the number of brokers.
+//
+static bool brokerBefore(const brokerFailoverState* data, int a, int b) {
+  if (a == data->lastGoodBroker) {
+    return true;
+  }
+  if (b == data->lastGoodBroker) {
+    return false;
+  }
+  return data->brokerHealth[a] > data->brokerHealth[b];
+}
+
+static int brokerOrder(int order[]) {
+  brokerFailoverState* data = failoverState();
+  int count = devConfig.brokerCount;
+  for (int i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  //insertion sort, it's at most MAX_MQTT_BROKERS entries. Stable so ties keep the configured order.
+  for (int i = 1; i < count; i++) {
+    int broker = order[i];
+    int j = i - 1;
+    while (j >= 0 && brokerBefore(data, broker, order[j])) {
+      order[j + 1] = order[j];
+      j--;
+    }
+    order[j + 1] = broker;
+  }
+  return count;
+}
+
+static void brokerResult(int broker, bool connected) {
+  brokerFailoverState* data = failoverState();
+  if (connected) {
+    data->lastGoodBroker = broker;
+    data->brokerHealth[broker] = min(data->brokerHealth[broker] + 1, BROKER_HEALTH_MAX);
+  } else {
+    data->brokerHealth[broker] = max(data->brokerHealth[broker] - 2, BROKER_HEALTH_MIN);
+  }
+}
+
+//
+// Point whichever client is in use at a broker.
+//
+static void selectBroker(int broker) {
+  const mqttBroker &endpoint = devConfig.brokers[broker];
+  currentBroker = broker;
+  Serial.print(F("MQTT broker: "));
+  Serial.print(endpoint.ip);
+  Serial.printf(":%u\r\n", endpoint.port);
+  if (mqttUseTls) {
+    tlsMqtt.setServer(endpoint.ip, endpoint.port);
+  } else {
+    mqttClient.setServer(endpoint.ip, endpoint.port);
+  }
+}
+
 bool MqttConnectWithTimeout(unsigned long Timeout) {
   unsigned long currMillis;
   unsigned long MqttStartMillis = millis();
+  if (mqttUseTls) {
+    tlsClient.setTimeout(Timeout);
+    return tlsMqttConnect();
+  }
   mqttClient.connect();
   do {
     Serial.print("`");
@@ -88,6 +309,153 @@ bool MqttConnectWithTimeout(unsigned long Timeout) {
   return true;
 }
 
+//
+// MqttConnectFailover
+// Try each configured broker with a short deadline until one connects.
+//
+bool MqttConnectFailover() {
+  int order[MAX_MQTT_BROKERS];
+  int count = brokerOrder(order);
+  for (int i = 0; i < count; i++) {
+    selectBroker(order[i]);
+    bool connected = MqttConnectWithTimeout(BROKER_ATTEMPT_MILLS);
+    brokerResult(order[i], connected);
+    if (connected) {
+      return true;
+    }
+    //abandon the attempt before moving on
+    mqttDisconnect(true);
+  }
+  Serial.println(F("no MQTT broker available"));
+  return false;
+}
+
+//
+// mqttInit
+// One time client setup. Call once from the mode's setup function; unlike
+// mqttApplyConfig() it must not run again on a config reload since the
+// client keeps every callback it is given.
+//
+void mqttInit() {
+  mqttClient.onPublish(onMqttPublish);
+}
+
+//
+// Setup MQTT stuff that doesn't need wifi to set up.
+// The client keeps pointers into devConfig for the credentials, so this needs
+// to be called again any time devConfig is modified.
+//
+void mqttApplyConfig() {
+  mqttUseTls = devConfig.useTls;
+
+  //Check if a username has been provided. The password is optional.
+  if (devConfig.mqttUser[0] != 0) {
+    mqttClient.setCredentials(devConfig.mqttUser, devConfig.mqttPw[0] != 0 ? devConfig.mqttPw : nullptr);
+  } else {
+    mqttClient.setCredentials(nullptr, nullptr);
+  }
+  //mqttClient.setClientId //consider doing this
+  if (mqttUseTls) {
+    //Pinning the broker's certificate avoids needing a CA store. The
+    //fingerprint was parsed when the config was decoded, so the bytes are
+    //used as is rather than having setFingerprint() parse text that could fail.
+    tlsFingerprintSet = false;
+    for (uint8_t b : devConfig.tlsFingerprint) {
+      tlsFingerprintSet |= b != 0;
+    }
+    if (tlsFingerprintSet) {
+      tlsClient.setFingerprint(devConfig.tlsFingerprint);
+    } else {
+      Serial.println(F("TLS MQTT enabled without a fingerprint, TLS connects are refused"));
+    }
+    tlsClient.setSession(&tlsSession);
+    tlsMqtt.setBufferSize(MQTT_TLS_BUFFER_SIZE);
+  }
+  if (devConfig.brokerCount > 0) {
+    int order[MAX_MQTT_BROKERS];
+    brokerOrder(order);
+    selectBroker(order[0]);
+  }
+}
+
+//
+// Persistent connection handling for the modes that don't sleep.
+// AsyncMqttClient doesn't reconnect on its own, so this is called regularly
+// to start a new (non-blocking) connection attempt, with a back off between them.
+// A TLS connection attempt does block for the handshake. PubSubClient also needs
+// to be polled to handle keep alives.
+// An attempt that hasn't connected by the next one counts as a failure and
+// moves on to the next broker.
+//
+static unsigned long lastMqttAttemptMillis;
+static bool mqttAttempted = false;
+static bool mqttAttemptPending = false;  //an attempt hasn't been scored yet
+
+void mqttMaintainConnection() {
+  unsigned long currMillis = millis();
+  if (mqttConnected()) {
+    if (mqttAttemptPending) {
+      mqttAttemptPending = false;
+      brokerResult(currentBroker, true);
+    }
+    if (mqttUseTls) {
+      tlsMqtt.loop();
+    }
+    return;
+  }
+  if (devConfig.brokerCount == 0) {
+    return;
+  }
+  if (mqttAttempted && currMillis - lastMqttAttemptMillis < TEN_SECONDS_IN_MILLS) {
+    return;
+  }
+  if (mqttAttempted) {
+    int order[MAX_MQTT_BROKERS];
+    int count = brokerOrder(order);
+    int position = 0;
+    if (mqttAttemptPending) {
+      brokerResult(currentBroker, false);
+    }
+    //the order may have changed with the new score, so look up where we are
+    while (position < count && order[position] != currentBroker) {
+      position++;
+    }
+    mqttDisconnect(true);
+    selectBroker(order[(position + 1) % count]);
+  }
+  mqttAttempted = true;
+  mqttAttemptPending = true;
+  lastMqttAttemptMillis = currMillis;
+  if (mqttUseTls) {
+    tlsClient.setTimeout(FIVE_SECONDS_IN_MILLS);
+    tlsMqttConnect();
+  } else {
+    mqttClient.connect();
+  }
+}
+
+//
+// Skip the back off on the next mqttMaintainConnection() call.
+//
+void mqttRetryNow() {
+  mqttAttempted = false;
+  mqttAttemptPending = false;
+}
+
+//
+// Bring up the I2C bus and the sensor.
+//
+void devModeSensorInit() {
+  Wire.begin();
+  Wire.setClock(100000);
+  sht.begin();
+
+  uint16_t stat = sht.readStatus();
+  Serial.print("SHT sensor status: ");
+  Serial.print(stat, HEX);
+  Serial.println();
+}
+
 
 //
 // Device mode worker function.
@@ -97,9 +465,9 @@ bool MqttConnectWithTimeout(unsigned long Timeout) {
 // TODO: Consider increasing sleep times in the event of a connection timeout.
 //
 void DevModeWifi(devRtcData* data) {
-  const char* config_ssid = jsonConfig["ssid"];
-  const char* config_pw = jsonConfig["WiFiPw"];
-  const char* config_hostname = jsonConfig["hostname"];
+  const char* config_ssid = devConfig.ssid;
+  const char* config_pw = devConfig.wifiPw;
+  const char* config_hostname = devConfig.hostname;
   boolean isConnectionRestored = false;
   if (data != nullptr) {
     Serial.println("trying to restore WiFi state");
@@ -114,7 +482,7 @@ void DevModeWifi(devRtcData* data) {
   }
   if (!isConnectionRestored) {
     Serial.print("regular wifi connection: ");
-    Serial.printf("%s\r\n", static_cast<String>(jsonConfig["ssid"]));
+    Serial.printf("%s\r\n", config_ssid);
     WiFi.persistent(false);
     Serial.print("setting hostname: ");
     Serial.println(config_hostname);
@@ -140,6 +508,9 @@ void DevModeWifi(devRtcData* data) {
 //may not need this. Here mostly for reference.
 void devModeEnd(devRtcData* data) {
   if (data != nullptr) {
+    const heapSample &heap = data->wakeHeap.record();
+    Serial.printf("heap free: %u max block: %u frag: %u%% (worst free: %u)\r\n",
+      heap.freeHeap, heap.maxFreeBlock, heap.fragmentation, data->wakeHeap.worst.freeHeap);
     WiFi.shutdown(data->state);
     rtcMemIface.save();
     delay(10);
@@ -157,29 +528,23 @@ void devModeEnd(devRtcData* data) {
 //
 // The flow for these sensors is as follows as they utilize deep sleep:
 // 1) bring up infrastructure for the sensors
-// 2) read the sensors
+// 2) read the sensors, timestamped with the time carried across the last sleep
 // 3) try to restore a wifi connection
 // 4) establish a new connection if restore fails
-// 5) connect to MQTT
-// 6) send data
-// 7) deep sleep
+// 5) sync the clock if it's due
+// 6) connect to MQTT
+// 7) send data
+// 8) deep sleep
 
 void setupDevMode() {
   float temp_c;
   float relativeHumidity;
-  //IPAddress MqttIp = MqttIp.fromString(static_cast<String>(jsonConfig["MqttIp"]));
-  IPAddress MqttIp;
-  uint16_t MqttPort = 1883;  //make configuable?
+  uint64_t sampleMillis;
 
-  Wire.begin();
-  Wire.setClock(100000);
-  sht.begin();
-
-  uint16_t stat = sht.readStatus();
-  Serial.print("SHT sensor status: ");
-  Serial.print(stat, HEX);
-  Serial.println();
+  clockOnWake(rtcMemIface.getData());
+  devModeSensorInit();
   sht.read();
+  sampleMillis = clockNowMillis();
   temp_c = sht.getTemperature();
   relativeHumidity = sht.getHumidity();
   Serial.print("temperature: ");
@@ -187,23 +552,25 @@ void setupDevMode() {
   Serial.print(" humidity: ");
   Serial.println(relativeHumidity);
   DevModeWifi(rtcMemIface.getData());
-  //Setup MQTT stuff that doesn't need wifi to set up.
-  //Check if a username an PW have been provided
-  if (jsonConfig.containsKey("MqttUser") && jsonConfig["MqttUser"].size() > 0 && jsonConfig.containsKey("MqttPw") && jsonConfig["MqttPw"].size() > 0) {
-    mqttClient.setCredentials(jsonConfig["MqttUser"], jsonConfig["MqttPw"]);
+  clockSyncIfDue(rtcMemIface.getData());
+  if (sampleMillis == 0) {
+    //time wasn't known at the reading but the sync happened right after it
+    sampleMillis = clockNowMillis();
   }
-  //mqttClient.setClientId //consider doing this
-  mqttClient.onPublish(onMqttPublish);
-  MqttIp.fromString(static_cast<String>(jsonConfig["MqttIp"]));
-  mqttClient.setServer(MqttIp, MqttPort);
-
+  mqttInit();
+  mqttApplyConfig();
 
   Serial.println("dev mode connect to wifi");
-  MqttConnectWithTimeout(10000);
+  MqttConnectFailover();
 
   topicsToPublish = 2;  //adjust based on the number of topics
-  mqttClient.publish(jsonConfig["MqttTempTopic"], 1, false, String(temp_c).c_str());
-  mqttClient.publish(jsonConfig["MqttHumTopic"], 1, false, String(relativeHumidity).c_str());
+  //Discovery documents are retained so only send them when they've changed.
+  if (devConfig.discoveryHash != 0 && !discoveryIsCurrent(rtcMemIface.getData(), devConfig.discoveryHash)) {
+    pendingDiscoveryHash = devConfig.discoveryHash;
+    topicsToPublish += publishDiscovery();
+  }
+  mqttPublish(devConfig.tempTopic, 1, false, timestampedValue(String(temp_c), sampleMillis).c_str());
+  mqttPublish(devConfig.humTopic, 1, false, timestampedValue(String(relativeHumidity), sampleMillis).c_str());
   loopMillis = millis();
 }
 
@@ -216,8 +583,12 @@ void loopDevMode() {
   if (topicsPublished >= topicsToPublish) {
     devRtcData* myRtcData = rtcMemIface.getData();
     Serial.println("topics published, sleeping");
+    if (pendingDiscoveryHash != 0) {
+      discoveryPublished(myRtcData, pendingDiscoveryHash);
+    }
     //don't worry about resetting variables, that will happen when the ESP wakes
-    mqttClient.disconnect(false);
+    mqttDisconnect(false);
+    clockBeforeSleep(myRtcData, ONE_MINUTE_IN_MICRO);
     devModeEnd(myRtcData);
     ESP.deepSleep(ONE_MINUTE_IN_MICRO, WAKE_RF_DEFAULT);
   }
@@ -227,8 +598,107 @@ void loopDevMode() {
   if (currMillis - loopMillis > FIVE_SECONDS_IN_MILLS) {
     devRtcData* myRtcData = rtcMemIface.getData();
     Serial.printf("Timeout waiting to publish (infra issues?) (%d published)\r\n", topicsPublished);
+    clockBeforeSleep(myRtcData, ONE_MINUTE_IN_MICRO);
     devModeEnd(myRtcData);
     ESP.deepSleep(ONE_MINUTE_IN_MICRO, WAKE_RF_DEFAULT);
   }
   delay(50);
 }
+
+
+//
+// Publishing while in staConfig mode.
+// The web server runs from the network stack's callbacks so all that's needed
+// to keep reporting is a task in loop() that reads the sensor and publishes over
+// a persistent MQTT connection. Every step is non-blocking so HTTP requests are
+// never held up: the sensor measurement is requested and then polled, and MQTT
+// connects asynchronously with a back off between attempts.
+//
+enum configPublishState {
+  publishWaiting,   //waiting for the next publish interval
+  publishMeasuring  //measurement requested, waiting for the sensor
+};
+
+static bool configPublishActive = false;
+static bool configPublishReloadNeeded = false;
+static configPublishState publishState = publishWaiting;
+static unsigned long lastPublishMillis;
+static unsigned long measureStartMillis;
+
+//
+// Setup() helper for staConfig mode. Must be called once WiFi is connected.
+//
+void setupConfigPublish() {
+  clockStartSntp();
+  devModeSensorInit();
+  mqttInit();
+  mqttApplyConfig();
+  mqttMaintainConnection();
+  //publish on the first pass through the task
+  lastPublishMillis = millis() - ONE_MINUTE_IN_MILLS;
+  configPublishActive = true;
+}
+
+//
+// Called by the web server when the configuration has been changed.
+// The actual reload is done from the task so the MQTT client isn't touched
+// from inside a web server callback.
+//
+void configPublishReload() {
+  configPublishReloadNeeded = true;
+}
+
+//
+// Cooperative task for staConfig mode. Called from the scheduler in loop().
+//
+void loopConfigPublish() {
+  unsigned long currMillis = millis();
+
+  if (!configPublishActive) {
+    return;
+  }
+
+  if (configPublishReloadNeeded) {
+    Serial.println(F("config changed, reconnecting MQTT"));
+    configPublishReloadNeeded = false;
+    mqttDisconnect(true);
+    mqttApplyConfig();
+    mqttRetryNow();
+  }
+
+  mqttMaintainConnection();
+
+  switch (publishState) {
+    case publishWaiting:
+      if (currMillis - lastPublishMillis >= ONE_MINUTE_IN_MILLS) {
+        sht.requestData();
+        measureStartMillis = currMillis;
+        publishState = publishMeasuring;
+      }
+      break;
+    case publishMeasuring:
+      if (sht.dataReady()) {
+        publishState = publishWaiting;
+        lastPublishMillis = currMillis;
+        if (!sht.readData()) {
+          Serial.println(F("SHT read failed"));
+          break;
+        }
+        if (!mqttConnected()) {
+          Serial.println(F("MQTT not connected, reading dropped"));
+          break;
+        }
+        uint64_t sampleMillis = clockNowMillis();
+        mqttPublish(devConfig.tempTopic, 1, false, timestampedValue(String(sht.getTemperature()), sampleMillis).c_str());
+        mqttPublish(devConfig.humTopic, 1, false, timestampedValue(String(sht.getHumidity()), sampleMillis).c_str());
+      } else if (currMillis - measureStartMillis > FIVE_SECONDS_IN_MILLS) {
+        Serial.println(F("SHT measurement timeout"));
+        publishState = publishWaiting;
+        lastPublishMillis = currMillis;
+      }
+      break;
+    default:
+      publishState = publishWaiting;
+      break;
+  }
+}
@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HEAP_STATS_H_
+#define HEAP_STATS_H_
+
+#include <Arduino.h>
+
+//
+// Heap telemetry.
+// Most of the HTML building is done by String concatenation and there is no
+// way to tell if an allocation fails short of a crash. Tracking the free heap,
+// the largest free block and the fragmentation makes it possible to see how
+// close to the edge things are running.
+//
+struct heapSample {
+  uint32_t freeHeap;
+  uint32_t maxFreeBlock;
+  uint8_t fragmentation;  //percent
+};
+
+//
+// heapStats
+// Keeps the most recent sample along with the worst values seen.
+// The worst values are tracked individually since the lowest free heap
+// and the smallest max block don't have to happen at the same time.
+// Kept as plain data (no initializers) so it can live in RTC RAM, where an
+// all zero instance is a valid "no samples yet" state.
+//
+class heapStats {
+
+public:
+  static heapSample sample() {
+    heapSample current;
+    current.freeHeap = ESP.getFreeHeap();
+    current.maxFreeBlock = ESP.getMaxFreeBlockSize();
+    current.fragmentation = ESP.getHeapFragmentation();
+    return current;
+  }
+
+  //
+  // record
+  // Take a sample and fold it into the worst case values.
+  //
+  const heapSample& record() {
+    last = sample();
+    if (samples == 0) {
+      worst = last;
+    } else {
+      worst.freeHeap = min(worst.freeHeap, last.freeHeap);
+      worst.maxFreeBlock = min(worst.maxFreeBlock, last.maxFreeBlock);
+      worst.fragmentation = max(worst.fragmentation, last.fragmentation);
+    }
+    samples++;
+    return last;
+  }
+
+  //
+  // toJson
+  // Report the values in a form that's easy to poll from a script.
+  //
+  String toJson() const {
+    return String("{\"samples\":") + samples +
+      ",\"last\":{\"free\":" + last.freeHeap + ",\"maxBlock\":" + last.maxFreeBlock + ",\"frag\":" + last.fragmentation +
+      "},\"worst\":{\"free\":" + worst.freeHeap + ",\"maxBlock\":" + worst.maxFreeBlock + ",\"frag\":" + worst.fragmentation + "}}";
+  }
+
+  uint32_t samples;
+  heapSample last;
+  heapSample worst;
+};
+
+#endif
@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <include/WiFiState.h>
+#include <RTCMemory.h>
+#include <Wire.h>
+
+#include "runtimeConfig.hpp"
+#include "rtcInterface.hpp"
+#include "deviceClock.hpp"
+#include "windowStats.hpp"
+#include "mqttDiscovery.hpp"
+
+//
+// Always-on, high rate mode for mains powered units.
+// WiFi and a single MQTT session stay up and the SHT3x runs in its periodic
+// measurement mode. Samples are kept in fixed point (hundredths of a degree
+// or of a percent) and aggregated into fixed windows. One summary per window
+// is published, with streaming of the raw samples as an option.
+//
+
+//shared with the other device modes, see deviceMode.cpp
+void DevModeWifi(devRtcData* data);
+void devModeSensorInit();
+void mqttInit();
+void mqttApplyConfig();
+void mqttMaintainConnection();
+bool mqttConnected();
+void mqttPublish(const char* topic, uint8_t qos, bool retain, const char* payload);
+
+#define SHT31_ADDRESS 0x44
+//SHT3x commands. Periodic modes use medium repeatability since the datasheet
+//warns of self heating at 10 measurements per second with high repeatability.
+#define SHT_CMD_PERIODIC_1MPS 0x2126
+#define SHT_CMD_PERIODIC_2MPS 0x2224
+#define SHT_CMD_PERIODIC_4MPS 0x2322
+#define SHT_CMD_PERIODIC_10MPS 0x2721
+#define SHT_CMD_FETCH_DATA 0xE000
+
+static windowStats tempWindow;
+static windowStats humWindow;
+static unsigned long windowStartMillis;
+static uint64_t windowStartEpochMillis;  //0 if the time wasn't known
+static unsigned long windowMillis;
+static bool rawStream = false;
+static bool mqttWasConnected = false;
+
+//
+// Format a fixed point value (hundredths) as a decimal string.
+//
+static String fixedToString(int32_t value) {
+  char buffer[16];
+  uint32_t magnitude = value < 0 ? -static_cast<int64_t>(value) : value;
+  snprintf(buffer, sizeof(buffer), "%s%u.%02u", value < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+  return String(buffer);
+}
+
+//Same for a value in thousandths, see windowStats::stddev()
+static String milliToString(uint32_t value) {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u.%03u", value / 1000, value % 1000);
+  return String(buffer);
+}
+
+static bool shtCommand(uint16_t command) {
+  Wire.beginTransmission(SHT31_ADDRESS);
+  Wire.write(command >> 8);
+  Wire.write(command & 0xFF);
+  return Wire.endTransmission() == 0;
+}
+
+//CRC-8, polynomial 0x31, init 0xFF as specified in the SHT3x datasheet
+static uint8_t shtCrc(const uint8_t* data, int length) {
+  uint8_t crc = 0xFF;
+  for (int i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+//
+// shtFetch
+// Read the latest periodic measurement.
+// Returns false if there is no new data (the sensor NACKs the read) or the CRC fails.
+//
+static bool shtFetch(int32_t &centiDegC, int32_t &centiRh) {
+  uint8_t data[6];
+  if (!shtCommand(SHT_CMD_FETCH_DATA)) {
+    return false;
+  }
+  if (Wire.requestFrom(SHT31_ADDRESS, 6) != 6) {
+    return false;
+  }
+  for (int i = 0; i < 6; i++) {
+    data[i] = Wire.read();
+  }
+  if (shtCrc(data, 2) != data[2] || shtCrc(&data[3], 2) != data[5]) {
+    Serial.println(F("SHT CRC error"));
+    return false;
+  }
+  uint32_t rawTemp = (data[0] << 8) | data[1];
+  uint32_t rawHum = (data[3] << 8) | data[4];
+  centiDegC = -4500 + static_cast<int32_t>((17500 * rawTemp) / 65535);
+  centiRh = static_cast<int32_t>((10000 * rawHum) / 65535);
+  return true;
+}
+
+//
+// Pick the periodic mode for the requested rate.
+// The sensor only supports a few rates so the fastest one that doesn't
+// exceed the request is used.
+//
+static uint16_t periodicCommandForRate(int rateHz, int &actualRate) {
+  if (rateHz >= 10) {
+    actualRate = 10;
+    return SHT_CMD_PERIODIC_10MPS;
+  }
+  if (rateHz >= 4) {
+    actualRate = 4;
+    return SHT_CMD_PERIODIC_4MPS;
+  }
+  if (rateHz >= 2) {
+    actualRate = 2;
+    return SHT_CMD_PERIODIC_2MPS;
+  }
+  actualRate = 1;
+  return SHT_CMD_PERIODIC_1MPS;
+}
+
+//
+// Publish the summaries for the window that just ended.
+//
+static void publishWindow(const char* baseTopic, const windowStats &stats, uint64_t endEpochMillis) {
+  String times;
+  if (baseTopic[0] == 0 || stats.count == 0) {
+    return;
+  }
+  if (windowStartEpochMillis != 0 && endEpochMillis != 0) {
+    times = String(",\"start\":") + formatEpochMillis(windowStartEpochMillis) + ",\"end\":" + formatEpochMillis(endEpochMillis);
+  }
+  String payload = String("{\"n\":") + stats.count + times +
+    ",\"min\":" + fixedToString(stats.minValue) +
+    ",\"max\":" + fixedToString(stats.maxValue) +
+    ",\"mean\":" + fixedToString(stats.mean()) +
+    ",\"stddev\":" + milliToString(stats.stddev()) + "}";
+  mqttPublish((String(baseTopic) + "/window").c_str(), 1, false, payload.c_str());
+}
+
+//
+// Setup() sub-function for staDeviceContinuous mode.
+// Returns the interval the sampling task should be run at. The sensor is
+// polled at twice its rate so no sample is missed to scheduling jitter.
+//
+unsigned long setupHighRateMode() {
+  int actualRate;
+  uint16_t command = periodicCommandForRate(devConfig.sampleRateHz, actualRate);
+
+  windowMillis = devConfig.windowSeconds * 1000UL;
+  rawStream = devConfig.rawStream;
+  Serial.printf("high rate mode: %d Hz, %u second windows, raw stream %s\r\n",
+    actualRate, devConfig.windowSeconds, rawStream ? "on" : "off");
+
+  devModeSensorInit();
+  if (!shtCommand(command)) {
+    Serial.println(F("failed to start periodic measurement"));
+  }
+
+  DevModeWifi(nullptr);
+  clockStartSntp();
+  mqttInit();
+  mqttApplyConfig();
+  mqttMaintainConnection();
+
+  tempWindow.reset();
+  humWindow.reset();
+  windowStartMillis = millis();
+  windowStartEpochMillis = clockNowMillis();
+  return 500 / actualRate;
+}
+
+//
+// Cooperative task: fetch a sample if there is one and roll the window over.
+//
+void loopHighRateSample() {
+  int32_t centiDegC;
+  int32_t centiRh;
+
+  if (shtFetch(centiDegC, centiRh)) {
+    tempWindow.add(centiDegC);
+    humWindow.add(centiRh);
+    if (rawStream && mqttConnected()) {
+      //raw samples are best effort, QoS 0
+      uint64_t sampleMillis = clockNowMillis();
+      mqttPublish(devConfig.tempTopic, 0, false, timestampedValue(fixedToString(centiDegC), sampleMillis).c_str());
+      mqttPublish(devConfig.humTopic, 0, false, timestampedValue(fixedToString(centiRh), sampleMillis).c_str());
+    }
+  }
+
+  if (millis() - windowStartMillis >= windowMillis) {
+    //fixed windows, so advance by the window length rather than restarting from now
+    windowStartMillis += windowMillis;
+    uint64_t windowEndEpochMillis = clockNowMillis();
+    if (mqttConnected()) {
+      publishWindow(devConfig.tempTopic, tempWindow, windowEndEpochMillis);
+      publishWindow(devConfig.humTopic, humWindow, windowEndEpochMillis);
+    } else {
+      Serial.println(F("MQTT not connected, window dropped"));
+    }
+    tempWindow.reset();
+    humWindow.reset();
+    windowStartEpochMillis = windowEndEpochMillis;
+  }
+}
+
+//
+// Cooperative task: keep the MQTT session up.
+// The discovery documents are sent on each new session. They're retained, so
+// sending them again is harmless, and an always-on unit rarely reconnects, so
+// unlike the deep sleep cycle there's no need to track what the broker has.
+//
+void loopHighRateMqtt() {
+  mqttMaintainConnection();
+  bool connected = mqttConnected();
+  if (connected && !mqttWasConnected && devConfig.discoveryHash != 0) {
+    publishDiscovery();
+  }
+  mqttWasConnected = connected;
+}
@@ -86,6 +86,8 @@ bool saveConfigFile(String configFileLoc) {
   // Serialize JSON to file
   if (serializeJson(jsonConfig, file) == 0) {
     Serial.println(F("Failed to write to file"));
+    file.close();
+    return false;
   }
   Serial.println(F("Config saved"));
   // Close the file
@@ -107,3 +109,12 @@ bool eraseConfig (String configFileLoc) {
   return true;
 }
 
+//
+// releaseConfigJson
+// Once the config has been decoded into devConfig (and the web pages have
+// loaded their values) the JSON data is no longer needed. Free it.
+//
+void releaseConfigJson() {
+  jsonConfig.clear();
+  jsonConfig.shrinkToFit();
+}
@@ -30,12 +30,18 @@ SOFTWARE.
 #include <RTCMemory.h>
 
 #include "configItems.hpp"
+#include "runtimeConfig.hpp"
 #include "HtmlRequests.hpp"
 #include "rtcInterface.hpp"
 
 //TODO: see if this can go into a header file when I do the header file cleanup.
 void setupDevMode();
 void loopDevMode();
+void setupConfigPublish();
+void loopConfigPublish();
+unsigned long setupHighRateMode();
+void loopHighRateSample();
+void loopHighRateMqtt();
 
 //TODO: Find a better place for this
 #define AP_IP_ADDR 192,168,30,1
@@ -46,13 +52,52 @@ void loopDevMode();
 //TODO: clean up commenting
 enum devOpMode {
   staDevice, //regular mode. Device is in station mode, it do the normal device functions
+  staDeviceContinuous, //staDevice for mains powered units. Stays awake and samples at a high rate (SampleRateHz config item)
   staConfig, //"station mode" meaning on the configured wifi network, but boots to server the configuration pages to allow config updates
   apConfig,  //AP mode config mode. Boot as an AP that can be connected to t in order to get to the config page that way. Config is not erased
   resetConfig, //erase the config settings, "factory reset"
-  errorNoFs
+  errorNoFs  //LittleFS failed to mount. The config pages are still served from flash so the device can be recovered.
 };
 
 
+//
+// Cooperative scheduler.
+// Tasks are run from loop() once their interval has elapsed. Each task must do
+// a small slice of work and return rather than block, since the ESP8266 network
+// stack (and the async web server with it) only gets serviced between them.
+//
+struct coopTask {
+  void (*run)();
+  unsigned long intervalMillis;
+  unsigned long lastRunMillis;
+};
+
+void runTasks(coopTask tasks[], size_t taskCount) {
+  unsigned long currMillis = millis();
+  for (size_t i = 0; i < taskCount; i++) {
+    if (currMillis - tasks[i].lastRunMillis >= tasks[i].intervalMillis) {
+      tasks[i].lastRunMillis = currMillis;
+      tasks[i].run();
+    }
+  }
+}
+
+//Tasks run alongside the web server in staConfig mode
+coopTask staConfigTasks[] = {
+  { loopConfigPublish, 50, 0 }
+};
+
+//Tasks for staDeviceContinuous mode. The sample interval is set by setupHighRateMode()
+coopTask highRateTasks[] = {
+  { loopHighRateSample, 50, 0 },
+  { loopHighRateMqtt, 50, 0 }
+};
+
+//Tasks for errorNoFs mode
+coopTask noFsTasks[] = {
+  { loopFormatFs, 100, 0 }
+};
+
 //globals
 AsyncWebServer server(80);
 ESP8266Timer ITimer;
@@ -67,6 +112,8 @@ String bootModeToStr(devOpMode BootMode) {
   switch (BootMode) {
     case staDevice:
       return "staDevice";
+    case staDeviceContinuous:
+      return "staDeviceContinuous";
     case staConfig:
       return "staConfig";
     case apConfig:
@@ -91,12 +138,16 @@ String bootModeToStr(devOpMode BootMode) {
 // In that case, it may be better to add the reset functionality right before the reset or deep sleep command.
 // The process of reading a sensor, restoring the WiFi connection, and reporting the data should hopefully take 
 // long enough to allow for reliable reset detection.
+// The timer is armed before RTC memory is set up, and commonInit() returns
+// early without setting it up if LittleFS doesn't mount, so there may be no data.
 //
 void IRAM_ATTR TimerHandler()
 {
   devRtcData* myRtcData = rtcMemIface.getData();
-  myRtcData->unhandledResetCount = 0;
-  rtcMemIface.save();
+  if (myRtcData != nullptr) {
+    myRtcData->unhandledResetCount = 0;
+    rtcMemIface.save();
+  }
   //This may be bad, but it seems to work OK for now.
   timer1_disable();
 }
@@ -111,8 +162,8 @@ void setupApConfigMode()
 {
   Serial.println("setupApConfigMode");
   String configEspHostname;
-  if (jsonConfig.containsKey("hostname")) {
-    configEspHostname = String("config:") + String(jsonConfig["hostname"]);
+  if (devConfig.hostname[0] != 0) {
+    configEspHostname = String("config:") + devConfig.hostname;
   } else {
     configEspHostname = String("config:") + WiFi.hostname().c_str();
   }
@@ -136,12 +187,12 @@ void setupApConfigMode()
 void setupReconfigMode()
 {
   Serial.println("setupReconfigMode");
-  WiFi.hostname(static_cast<String>(jsonConfig["hostname"]).c_str());
+  WiFi.hostname(devConfig.hostname);
   Serial.print(F("Connecting to "));
-  Serial.println(static_cast<String>(jsonConfig["ssid"]));
+  Serial.println(devConfig.ssid);
 
   WiFi.mode(WIFI_STA);
-  WiFi.begin(static_cast<String>(jsonConfig["ssid"]), static_cast<String>(jsonConfig["WiFiPw"]));
+  WiFi.begin(devConfig.ssid, devConfig.wifiPw);
 
   while (WiFi.status() != WL_CONNECTED) {
     delay(500);
@@ -154,6 +205,8 @@ void setupReconfigMode()
 
   registerHtmlInterfaces();
   server.begin();
+  //keep reporting while the config pages are up
+  setupConfigPublish();
 }
 
 
@@ -163,17 +216,30 @@ void setupReconfigMode()
 bool commonInit(){
   //devRtcData* myRtcData = rtcMemIface.getData();
   devRtcData* myRtcData = nullptr;
+  String configError;
   ITimer.attachInterruptInterval(750000, TimerHandler);
   Serial.println(F("Mount LittleFS"));
   if (!LittleFS.begin()) {
     Serial.println(F("LittleFS mount failed"));
+    fsMounted = false;
     BootMode =  errorNoFs;
     return false;
   }
 
+  clearRuntimeConfig(devConfig);
   if(loadConfigFile(CONFIG_FILE)) {
     Serial.println (F("config loaded"));
     BootMode =  staDevice; 
+    if (!decodeRuntimeConfig(jsonConfig, devConfig, configError)) {
+      //shouldn't happen since the config is checked before it is saved,
+      //but the device can't run with it so let the user fix it.
+      Serial.print(F("invalid config: "));
+      Serial.println(configError);
+      BootMode = apConfig;
+    } else if (devConfig.sampleRateHz > 0) {
+      //a sample rate means the unit is mains powered and doesn't need to sleep
+      BootMode = staDeviceContinuous;
+    }
   } else {
     //There is an FS so that's OK, but no config.
     BootMode =  apConfig;
@@ -216,7 +282,7 @@ bool commonInit(){
         break;
       case 2:
         Serial.println(F("reconfig on configed network"));
-        if (BootMode == staDevice) {
+        if (BootMode == staDevice || BootMode == staDeviceContinuous) {
           BootMode = staConfig;
         } else {
           //just go into normal config mode.
@@ -262,11 +328,22 @@ void setup() {
       break;
     case staDevice:
       digitalWrite(LED_BUILTIN, HIGH);
+      releaseConfigJson();
       setupDevMode();
       break;
+    case staDeviceContinuous:
+      digitalWrite(LED_BUILTIN, HIGH);
+      releaseConfigJson();
+      highRateTasks[0].intervalMillis = setupHighRateMode();
+      break;
     case apConfig:
       setupApConfigMode();
       break;
+    case errorNoFs:
+      //the web UI is embedded in the firmware so it doesn't need the FS
+      Serial.println(F("No filesystem, starting config pages anyway"));
+      setupApConfigMode();
+      break;
     case resetConfig:
       //devConfig.clearConfig();
       eraseConfig(CONFIG_FILE);
@@ -286,5 +363,11 @@ void loop() {
 // check BootMode and do the right loop required based on that.
   if (BootMode == staDevice) {
     loopDevMode();
+  } else if (BootMode == staConfig) {
+    runTasks(staConfigTasks, std::size(staConfigTasks));
+  } else if (BootMode == staDeviceContinuous) {
+    runTasks(highRateTasks, std::size(highRateTasks));
+  } else if (BootMode == errorNoFs) {
+    runTasks(noFsTasks, std::size(noFsTasks));
   }
 }
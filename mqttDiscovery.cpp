@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <include/WiFiState.h>
+#include <RTCMemory.h>
+#include <LittleFS.h>
+
+#include "runtimeConfig.hpp"
+#include "rtcInterface.hpp"
+#include "mqttDiscovery.hpp"
+
+//see deviceMode.cpp
+void mqttPublish(const char* topic, uint8_t qos, bool retain, const char* payload);
+
+//
+// Home Assistant MQTT discovery.
+// Each sensor gets a retained config document under
+// <prefix>/sensor/<device id>/<entity id>/config. Since the documents are retained
+// by the broker they only need to be sent when something in them changes.
+// A hash of what they're built from is worked out when the config is decoded
+// (devConfig.discoveryHash) and the last one acknowledged is kept in RTC RAM
+// (and a copy on flash), so a normal wake doesn't build them at all.
+//
+struct discoveryEntity {
+  const char* id;
+  const char* name;
+  const char* deviceClass;
+  const char* unit;
+  const char* stateTopic;  //points into devConfig
+};
+
+static const discoveryEntity discoveryEntities[] = {
+  { "temperature", "Temperature", "temperature", "°C", devConfig.tempTopic },
+  { "humidity", "Humidity", "humidity", "%", devConfig.humTopic }
+};
+
+//
+// The device ID is used in both the discovery topic and the unique IDs so it needs
+// to be stable. The configured hostname is used if there is one.
+//
+static String discoveryDeviceId() {
+  if (devConfig.hostname[0] != 0) {
+    return String(devConfig.hostname);
+  }
+  char chipId[16];
+  snprintf(chipId, sizeof(chipId), "esp8266-%06x", ESP.getChipId());
+  return String(chipId);
+}
+
+//
+// buildDiscoveryDoc
+// Build the topic and payload for one entity.
+// The high rate mode only publishes window summaries unless RawStream is on,
+// so there the entity follows the mean from <topic>/window.
+// Returns false if discovery is disabled or the entity has no state topic configured.
+//
+static bool buildDiscoveryDoc(const discoveryEntity &entity, String &topic, String &payload) {
+  if (devConfig.discoveryPrefix[0] == 0 || entity.stateTopic[0] == 0) {
+    return false;
+  }
+  String deviceId = discoveryDeviceId();
+  topic = String(devConfig.discoveryPrefix) + "/sensor/" + deviceId + "/" + entity.id + "/config";
+
+  JsonDocument doc;
+  doc["name"] = entity.name;
+  doc["unique_id"] = deviceId + "_" + entity.id;
+  if (devConfig.sampleRateHz > 0) {
+    doc["state_topic"] = String(entity.stateTopic) + "/window";
+    doc["value_template"] = "{{ value_json.mean }}";
+  } else {
+    doc["state_topic"] = entity.stateTopic;
+    if (devConfig.timestampPayloads) {
+      //samples are published as {"value":..,"ts":..}
+      doc["value_template"] = "{{ value_json.value }}";
+    }
+  }
+  doc["device_class"] = entity.deviceClass;
+  doc["unit_of_measurement"] = entity.unit;
+  doc["state_class"] = "measurement";
+  JsonObject device = doc["device"].to<JsonObject>();
+  device["identifiers"].add(deviceId);
+  device["name"] = deviceId;
+  device["model"] = "ESP8266 SHT30";
+  device["sw_version"] = FIRMWARE_VERSION;
+  payload.remove(0, payload.length());
+  serializeJson(doc, payload);
+  return true;
+}
+
+static uint32_t readStoredDiscoveryHash() {
+  uint32_t hash = 0;
+  File hashFile = LittleFS.open(DISCOVERY_HASH_FILE, "r");
+  if (!hashFile) {
+    return 0;
+  }
+  if (hashFile.read(reinterpret_cast<uint8_t*>(&hash), sizeof(hash)) != sizeof(hash)) {
+    hash = 0;
+  }
+  hashFile.close();
+  return hash;
+}
+
+//
+// discoveryIsCurrent
+// Check the hash against the one in RTC RAM. Flash is only read when the RTC copy
+// is unknown (first boot after a power loss) so a normal wake doesn't touch the FS.
+//
+bool discoveryIsCurrent(devRtcData* data, uint32_t hash) {
+  if (data != nullptr && data->discoveryHash != 0) {
+    return data->discoveryHash == hash;
+  }
+  uint32_t storedHash = readStoredDiscoveryHash();
+  if (data != nullptr) {
+    data->discoveryHash = storedHash;
+  }
+  return storedHash == hash;
+}
+
+//
+// publishDiscovery
+// Queue the retained discovery documents.
+// Returns the number of messages queued so the caller can wait for them.
+//
+int publishDiscovery() {
+  String topic;
+  String payload;
+  int published = 0;
+  for (const discoveryEntity &entity : discoveryEntities) {
+    if (buildDiscoveryDoc(entity, topic, payload)) {
+      Serial.print(F("publishing discovery: "));
+      Serial.println(topic);
+      mqttPublish(topic.c_str(), 1, true, payload.c_str());
+      published++;
+    }
+  }
+  return published;
+}
+
+//
+// discoveryPublished
+// Record the hash once the broker has acknowledged everything.
+// Flash is only written when the hash actually changed.
+//
+void discoveryPublished(devRtcData* data, uint32_t hash) {
+  if (data != nullptr) {
+    data->discoveryHash = hash;
+  }
+  if (readStoredDiscoveryHash() == hash) {
+    return;
+  }
+  File hashFile = LittleFS.open(DISCOVERY_HASH_FILE, "w");
+  if (!hashFile) {
+    Serial.println(F("Failed to save discovery hash"));
+    return;
+  }
+  hashFile.write(reinterpret_cast<const uint8_t*>(&hash), sizeof(hash));
+  hashFile.close();
+}
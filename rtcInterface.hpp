@@ -25,12 +25,44 @@ SOFTWARE.
 #ifndef RTC_INTERFACE_H_
 #define RTC_INTERFACE_H_
 
+#include <BearSSLHelpers.h>
+#include "heapStats.hpp"
+#include "runtimeConfig.hpp"
+
+//MQTT broker failover state. Only valid while brokerListHash matches devConfig.
+typedef struct {
+  uint32_t brokerListHash;
+  uint8_t lastGoodBroker;
+  int8_t brokerHealth[MAX_MQTT_BROKERS];
+  uint8_t mflnProbed;     //bit per broker, set once a TLS connect after the probe worked
+  uint8_t mflnSupported;  //bit per broker, the broker accepts TLS_MFLN_SIZE records
+} brokerFailoverState;
+
+//Wall clock carried across deep sleep. See deviceClock.cpp.
+typedef struct {
+  uint64_t epochMillisAtSleep;   //estimated wall time when the last deep sleep started, 0 if unknown
+  uint64_t sleepMicros;          //requested length of that sleep
+  uint64_t sleepMicrosSinceSync; //total requested sleep since the last SNTP sync
+  int32_t driftPpm;              //learned correction to the requested sleep time
+  uint16_t wakesSinceSync;
+  bool synced;                   //there has been a sync since the RTC data was reset
+} clockState;
+
 //Data to be saved to the RTC RAM
 //This holds Wifi state data and a count of "interrupted boots" 
 //for boot mode mode overrides
 typedef struct {
   unsigned int unhandledResetCount;
   WiFiState state;
+  uint32_t discoveryHash; //hash of the last acknowledged HA discovery data, 0 if unknown
+  heapStats wakeHeap;     //heap at the end of each wake
+  //BearSSL session from the last TLS connection, raw bytes since
+  //BearSSL::Session has a constructor. Lets the next wake resume the session.
+  uint8_t tlsSession[sizeof(BearSSL::Session)];
+  bool tlsSessionValid;
+  uint32_t tlsConnectMillis; //time taken by the last TLS connect
+  brokerFailoverState brokerState;
+  clockState clock;
 } devRtcData;
 
 //please ensure these are in your .ino file.
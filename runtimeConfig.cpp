@@ -0,0 +1,286 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <coredecls.h>  //crc32()
+
+#include "runtimeConfig.hpp"
+
+runtimeConfig devConfig;
+
+//
+// copyConfigString
+// Copy a string value into a fixed buffer. A missing key is an empty string.
+// Returns false if the value doesn't fit.
+//
+static bool copyConfigString(JsonDocument &json, const char* key, char* dest, size_t destSize, String &error) {
+  const char* value = json[key] | "";
+  size_t length = strlen(value);
+  if (length >= destSize) {
+    error = String(key) + " is too long";
+    return false;
+  }
+  memcpy(dest, value, length + 1);
+  return true;
+}
+
+//
+// parseConfigNumber
+// Config values are all stored as strings. A blank value gives defaultValue.
+// Returns false if the value isn't a whole number between minValue and maxValue.
+//
+static bool parseConfigNumber(JsonDocument &json, const char* key, long minValue, long maxValue,
+                              long defaultValue, long &result, String &error) {
+  String value = json[key] | "";
+  value.trim();
+  if (value.length() == 0) {
+    result = defaultValue;
+    return true;
+  }
+  for (unsigned int i = 0; i < value.length(); i++) {
+    if (!isDigit(value[i])) {
+      error = String(key) + " is not a number";
+      return false;
+    }
+  }
+  result = value.toInt();
+  if (result < minValue || result > maxValue) {
+    error = String(key) + " must be between " + minValue + " and " + maxValue;
+    return false;
+  }
+  return true;
+}
+
+static bool parseConfigBool(JsonDocument &json, const char* key, bool &result, String &error) {
+  String value = json[key] | "";
+  value.trim();
+  if (value.length() == 0 || value == "0" || value.equalsIgnoreCase("no") || value.equalsIgnoreCase("false")) {
+    result = false;
+    return true;
+  }
+  if (value == "1" || value.equalsIgnoreCase("yes") || value.equalsIgnoreCase("true")) {
+    result = true;
+    return true;
+  }
+  error = String(key) + " must be yes or no";
+  return false;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+//
+// parseFingerprint
+// A SHA1 fingerprint is 20 bytes, each written as two hex digits. Takes the
+// same format as BearSSL::WiFiClientSecure::setFingerprint(const char*): the
+// bytes may be followed by any number of ':' or ' ', nothing else.
+//
+static bool parseFingerprint(const char* text, uint8_t fingerprint[20]) {
+  int bytes = 0;
+  while (bytes < 20 && *text != 0) {
+    int high = hexValue(text[0]);
+    int low = high < 0 ? -1 : hexValue(text[1]);
+    if (low < 0) {
+      return false;
+    }
+    fingerprint[bytes++] = (high << 4) | low;
+    text += 2;
+    while (*text == ':' || *text == ' ') {
+      text++;
+    }
+  }
+  return bytes == 20 && *text == 0;
+}
+
+//
+// parseBrokerList
+// The broker list is a comma separated list of ip[:port] entries, tried in order.
+// Entries without a port get defaultPort.
+//
+static bool parseBrokerList(const char* list, uint16_t defaultPort, runtimeConfig &config, String &error) {
+  String entries = list;
+  int start = 0;
+
+  config.brokerCount = 0;
+  config.brokerListHash = crc32(list, strlen(list));
+  entries.trim();
+  if (entries.length() == 0) {
+    return true;
+  }
+  while (start <= static_cast<int>(entries.length())) {
+    int end = entries.indexOf(',', start);
+    if (end < 0) {
+      end = entries.length();
+    }
+    String entry = entries.substring(start, end);
+    entry.trim();
+    start = end + 1;
+
+    if (config.brokerCount >= MAX_MQTT_BROKERS) {
+      error = String(F("at most ")) + MAX_MQTT_BROKERS + F(" MQTT brokers can be configured");
+      return false;
+    }
+    mqttBroker &broker = config.brokers[config.brokerCount];
+    broker.port = defaultPort;
+    int colon = entry.indexOf(':');
+    if (colon >= 0) {
+      String portText = entry.substring(colon + 1);
+      //toInt() stops at the first non-digit, so check them all first
+      bool digitsOnly = portText.length() > 0 && portText.length() <= 5;
+      for (unsigned int i = 0; i < portText.length(); i++) {
+        digitsOnly = digitsOnly && isDigit(portText[i]);
+      }
+      long port = digitsOnly ? portText.toInt() : 0;
+      if (port <= 0 || port > 65535) {
+        error = String(F("MQTT broker \"")) + entry + F("\" has an invalid port");
+        return false;
+      }
+      broker.port = port;
+      entry.remove(colon);
+    }
+    if (!broker.ip.fromString(entry)) {
+      error = String(F("MQTT broker \"")) + entry + F("\" is not a valid IP address");
+      return false;
+    }
+    config.brokerCount++;
+  }
+  return true;
+}
+
+//
+// discoveryHash
+// Hash of everything the Home Assistant discovery documents are built from
+// (see mqttDiscovery.cpp), so a wake can tell whether they need to be sent
+// without building them. The entity table and document layout only change
+// with the firmware, which FIRMWARE_VERSION covers. The state topic and
+// value template depend on the mode and the payload format.
+// Returns 0 if there is nothing to publish.
+//
+static uint32_t discoveryHash(const runtimeConfig &config) {
+  if (config.discoveryPrefix[0] == 0 || (config.tempTopic[0] == 0 && config.humTopic[0] == 0)) {
+    return 0;
+  }
+  const char* inputs[] = { FIRMWARE_VERSION, config.discoveryPrefix, config.hostname, config.tempTopic, config.humTopic,
+    config.sampleRateHz > 0 ? "window" : config.timestampPayloads ? "json" : "plain" };
+  uint32_t hash = 0xffffffff;
+  for (const char* input : inputs) {
+    //the terminator keeps "ab","c" and "a","bc" apart
+    hash = crc32(input, strlen(input) + 1, hash);
+  }
+  //0 means "unknown" in RTC RAM
+  return hash == 0 ? 1 : hash;
+}
+
+void clearRuntimeConfig(runtimeConfig &config) {
+  memset(config.hostname, 0, sizeof(config.hostname));
+  memset(config.ssid, 0, sizeof(config.ssid));
+  memset(config.wifiPw, 0, sizeof(config.wifiPw));
+  for (mqttBroker &broker : config.brokers) {
+    broker.ip = IPAddress();
+    broker.port = MQTT_PORT;
+  }
+  config.brokerCount = 0;
+  config.brokerListHash = 0;
+  config.useTls = false;
+  memset(config.tlsFingerprint, 0, sizeof(config.tlsFingerprint));
+  memset(config.mqttUser, 0, sizeof(config.mqttUser));
+  memset(config.mqttPw, 0, sizeof(config.mqttPw));
+  memset(config.tempTopic, 0, sizeof(config.tempTopic));
+  memset(config.humTopic, 0, sizeof(config.humTopic));
+  memset(config.discoveryPrefix, 0, sizeof(config.discoveryPrefix));
+  memset(config.ntpServer, 0, sizeof(config.ntpServer));
+  config.sampleRateHz = 0;
+  config.windowSeconds = DEFAULT_WINDOW_SECONDS;
+  config.rawStream = false;
+  config.timestampPayloads = false;
+  config.discoveryHash = 0;
+}
+
+//
+// decodeRuntimeConfig
+// Decode and validate the JSON config data into config.
+// This is used both at boot and when the config is saved from the web pages,
+// so a bad value is caught when the user enters it rather than on every wake.
+// config is only partially updated on failure, so decode into a scratch copy
+// if the current config needs to be kept.
+//
+// Returns false with a description in error if anything is invalid.
+//
+bool decodeRuntimeConfig(JsonDocument &json, runtimeConfig &config, String &error) {
+  long number;
+
+  clearRuntimeConfig(config);
+  if (!copyConfigString(json, "hostname", config.hostname, sizeof(config.hostname), error) ||
+      !copyConfigString(json, "ssid", config.ssid, sizeof(config.ssid), error) ||
+      !copyConfigString(json, "WiFiPw", config.wifiPw, sizeof(config.wifiPw), error) ||
+      !copyConfigString(json, "MqttUser", config.mqttUser, sizeof(config.mqttUser), error) ||
+      !copyConfigString(json, "MqttPw", config.mqttPw, sizeof(config.mqttPw), error) ||
+      !copyConfigString(json, "MqttTempTopic", config.tempTopic, sizeof(config.tempTopic), error) ||
+      !copyConfigString(json, "MqttHumTopic", config.humTopic, sizeof(config.humTopic), error) ||
+      !copyConfigString(json, "MqttDiscoveryPrefix", config.discoveryPrefix, sizeof(config.discoveryPrefix), error) ||
+      !copyConfigString(json, "NtpServer", config.ntpServer, sizeof(config.ntpServer), error)) {
+    return false;
+  }
+
+  //parsed here rather than by the TLS client so a bad one is caught on save
+  const char* fingerprint = json["MqttTlsFingerprint"] | "";
+  if (fingerprint[0] != 0) {
+    if (!parseFingerprint(fingerprint, config.tlsFingerprint)) {
+      error = F("TLS fingerprint must be 20 hex bytes, separated by : or spaces");
+      return false;
+    }
+    config.useTls = true;
+  }
+  //the key predates multiple brokers, kept so existing configs still load
+  if (!parseBrokerList(json["MqttIp"] | "", config.useTls ? MQTT_TLS_PORT : MQTT_PORT, config, error)) {
+    return false;
+  }
+
+  if (!parseConfigNumber(json, "SampleRateHz", 0, MAX_SAMPLE_RATE_HZ, 0, number, error)) {
+    return false;
+  }
+  config.sampleRateHz = number;
+  if (!parseConfigNumber(json, "WindowSeconds", 1, MAX_WINDOW_SECONDS, DEFAULT_WINDOW_SECONDS, number, error)) {
+    return false;
+  }
+  config.windowSeconds = number;
+  if (!parseConfigBool(json, "RawStream", config.rawStream, error)) {
+    return false;
+  }
+  if (!parseConfigBool(json, "TimestampPayloads", config.timestampPayloads, error)) {
+    return false;
+  }
+  config.discoveryHash = discoveryHash(config);
+  return true;
+}
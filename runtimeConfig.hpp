@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef RUNTIME_CONFIG_H_
+#define RUNTIME_CONFIG_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <IPAddress.h>
+
+#define MQTT_PORT 1883
+#define MQTT_TLS_PORT 8883
+#define DEFAULT_WINDOW_SECONDS 60
+#define MAX_SAMPLE_RATE_HZ 10
+#define MAX_WINDOW_SECONDS 3600
+#define MAX_MQTT_BROKERS 4
+
+//Bump this when releasing new firmware so Home Assistant sees the new version.
+//It's part of the discovery hash, so this is also what gets the discovery
+//documents republished after a change to them.
+#define FIRMWARE_VERSION "0.2.0"
+
+struct mqttBroker {
+  IPAddress ip;
+  uint16_t port;
+};
+
+//
+// runtimeConfig
+// The configuration decoded and validated once from the JSON config data.
+// Everything the device modes need is here in ready to use form so the
+// JsonDocument can be released once it has been decoded.
+// String buffers are sized from the maxLength of the matching config item.
+//
+struct runtimeConfig {
+  char hostname[33];
+  char ssid[33];
+  char wifiPw[65];
+  mqttBroker brokers[MAX_MQTT_BROKERS];  //in order of preference
+  uint8_t brokerCount;
+  uint32_t brokerListHash;  //identifies the list so state kept about it can be invalidated
+  bool useTls;
+  uint8_t tlsFingerprint[20];  //SHA1 of the broker's certificate, only set if useTls
+  char mqttUser[65];
+  char mqttPw[65];
+  char tempTopic[129];
+  char humTopic[129];
+  char discoveryPrefix[65];
+  char ntpServer[65];
+  uint8_t sampleRateHz;     //0 for the deep sleep cycle
+  uint16_t windowSeconds;
+  bool rawStream;
+  bool timestampPayloads;   //{"value":..,"ts":..} rather than the plain value
+  uint32_t discoveryHash;   //what goes into the HA discovery documents, 0 if there are none
+};
+
+extern runtimeConfig devConfig;
+
+bool decodeRuntimeConfig(JsonDocument &json, runtimeConfig &config, String &error);
+void clearRuntimeConfig(runtimeConfig &config);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <malloc.h>
+#include <new>
+
+#include "allocCounter.hpp"
+
+extern "C" {
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+}
+
+static allocStats counters;
+//allocScope sets this to find the peak since the scope started
+static int64_t peakSince;
+
+static void countAllocation(void *ptr, size_t requested) {
+  if (!ptr) {
+    return;
+  }
+  counters.allocations++;
+  counters.bytes += requested;
+  counters.liveBytes += malloc_usable_size(ptr);
+  if (counters.liveBytes > counters.peakBytes) {
+    counters.peakBytes = counters.liveBytes;
+  }
+  if (counters.liveBytes > peakSince) {
+    peakSince = counters.liveBytes;
+  }
+}
+
+static void countFree(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  counters.frees++;
+  counters.liveBytes -= malloc_usable_size(ptr);
+}
+
+extern "C" {
+
+void *__wrap_malloc(size_t size) {
+  void *ptr = __real_malloc(size);
+  countAllocation(ptr, size);
+  return ptr;
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  void *ptr = __real_calloc(count, size);
+  countAllocation(ptr, count * size);
+  return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  countFree(ptr);
+  void *result = __real_realloc(ptr, size);
+  if (ptr) {
+    //a realloc isn't a free plus an allocation as far as the counts go
+    counters.frees--;
+  }
+  countAllocation(result, size);
+  return result;
+}
+
+void __wrap_free(void *ptr) {
+  countFree(ptr);
+  __real_free(ptr);
+}
+}
+
+void *operator new(size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+allocStats allocSnapshot() {
+  return counters;
+}
+
+allocScope::allocScope() : start(counters) {
+  peakSince = counters.liveBytes;
+}
+
+allocStats allocScope::delta() const {
+  allocStats result;
+  result.allocations = counters.allocations - start.allocations;
+  result.frees = counters.frees - start.frees;
+  result.bytes = counters.bytes - start.bytes;
+  result.liveBytes = counters.liveBytes - start.liveBytes;
+  result.peakBytes = peakSince - start.liveBytes;
+  return result;
+}
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" {
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+}
+
+//
+// Allocation counting for the host build.
+// malloc/realloc/calloc/free are wrapped at link time (-Wl,--wrap) and
+// operator new/delete are replaced to go through them, so everything the
+// sketch code allocates is counted, String buffers included.
+//
+struct allocStats {
+  uint64_t allocations;  //malloc, calloc, realloc and new calls
+  uint64_t frees;
+  uint64_t bytes;        //total requested
+  int64_t liveBytes;     //currently allocated
+  int64_t peakBytes;     //high water mark of liveBytes
+};
+
+allocStats allocSnapshot();
+
+//
+// allocScope
+// Counts what happens between construction and delta().
+// peakBytes in the delta is the high water mark above the starting live bytes.
+//
+class allocScope {
+public:
+  allocScope();
+  allocStats delta() const;
+
+private:
+  allocStats start;
+};
+
+//
+// uncountedAllocator
+// For host only buffers that stand in for something the device doesn't take
+// from the heap, like the web server's fixed size send buffer.
+//
+template <typename T>
+struct uncountedAllocator {
+  typedef T value_type;
+  uncountedAllocator() = default;
+  template <typename U>
+  uncountedAllocator(const uncountedAllocator<U> &) {}
+  T *allocate(size_t n) { return static_cast<T *>(__real_malloc(n * sizeof(T))); }
+  void deallocate(T *ptr, size_t) { __real_free(ptr); }
+  bool operator==(const uncountedAllocator &) const { return true; }
+  bool operator!=(const uncountedAllocator &) const { return false; }
+};
+
+typedef std::basic_string<char, std::char_traits<char>, uncountedAllocator<char>> uncountedString;
+
+#endif
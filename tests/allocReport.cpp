@@ -0,0 +1,78 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include "allocCounter.hpp"
+#include "hostSketch.hpp"
+
+//
+// Allocation report for the web pages.
+// Each row is one call, measured from just before the call to just after it
+// returns. "retained" is what's still allocated afterwards (the response, or
+// state like configFields), "peak" is the most that was live at once on top
+// of what was there before the call.
+//
+
+static void printRow(const char *name, const allocStats &stats) {
+  printf("%-28s %8llu %8llu %9llu %8lld %9lld\n", name,
+         static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.frees),
+         static_cast<unsigned long long>(stats.bytes), static_cast<long long>(stats.peakBytes),
+         static_cast<long long>(stats.liveBytes));
+}
+
+static void measureRequest(const char *name, WebRequestMethod method, const char *uri,
+                           const std::vector<std::pair<String, String>> &params = {}) {
+  std::unique_ptr<AsyncWebServerRequest> req(new AsyncWebServerRequest());
+  for (const auto &p : params) {
+    req->addParam(p.first, p.second, method == HTTP_POST);
+  }
+  allocScope scope;
+  server.handle(method, uri, req.get());
+  printRow(name, scope.delta());
+}
+
+int main() {
+  printf("%-28s %8s %8s %9s %8s %9s\n", "", "allocs", "frees", "bytes", "peak", "retained");
+
+  //once to get the one time allocations out of the way
+  bootConfigMode(typicalConfigJson);
+  loadBootConfig(typicalConfigJson);
+  {
+    allocScope scope;
+    registerHtmlInterfaces();
+    printRow("registerHtmlInterfaces", scope.delta());
+  }
+
+  measureRequest("GET /", HTTP_GET, "/");
+  measureRequest("GET /index.htm", HTTP_GET, "/index.htm");
+  measureRequest("GET /fields.htm", HTTP_GET, "/fields.htm");
+  measureRequest("GET /heap", HTTP_GET, "/heap");
+  measureRequest("GET /missing", HTTP_GET, "/missing");
+  measureRequest("POST /config", HTTP_POST, "/config",
+                 { { "hostname", "garage-sensor" }, { "MqttTempTopic", "home/garage/temperature" } });
+  measureRequest("POST /config (rejected)", HTTP_POST, "/config", { { "noSuchItem", "x" } });
+  measureRequest("POST /save", HTTP_POST, "/save");
+  measureRequest("POST /reset", HTTP_POST, "/reset");
+  measureRequest("POST /save (erase)", HTTP_POST, "/save");
+  measureRequest("POST /reboot", HTTP_POST, "/reboot");
+  return 0;
+}
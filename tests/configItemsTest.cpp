@@ -0,0 +1,369 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <map>
+#include <string>
+
+#include "hostSketch.hpp"
+#include "testing.hpp"
+#include "webAssets.hpp"
+
+//
+// Property and fuzz tests for configurationItems and the config web pages.
+// Random cases use testRandom(); rerun with TEST_SEED=<seed> to reproduce.
+//
+
+typedef std::map<std::string, std::string> valueMap;
+
+struct formField {
+  String key;
+  unsigned int maxLength;
+  bool password;
+};
+
+//The item list as the browser sees it, taken from the generated form
+static std::vector<formField> formFields() {
+  std::vector<formField> fields;
+  int pos = 0;
+  while ((pos = configFields.indexOf("<input type=\"", pos)) >= 0) {
+    formField field;
+    field.password = configFields.substring(pos + 13).startsWith("password");
+    int name = configFields.indexOf("name=\"", pos) + 6;
+    field.key = configFields.substring(name, configFields.indexOf('"', name));
+    int maxLength = configFields.indexOf("maxlength=\"", pos) + 11;
+    field.maxLength = configFields.substring(maxLength, configFields.indexOf('"', maxLength)).toInt();
+    fields.push_back(field);
+    pos = maxLength;
+  }
+  return fields;
+}
+
+static valueMap currentValues() {
+  JsonDocument doc;
+  valueMap values;
+  configItems.dumpToJson(doc);
+  for (const JsonMember &m : doc.allMembers()) {
+    values[m.key] = m.value;
+  }
+  return values;
+}
+
+static std::string htmlUnescape(const std::string &text) {
+  static const std::pair<const char *, char> entities[] = {
+    { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&#39;", '\'' }, { "&#37;", '%' },
+  };
+  std::string result;
+  for (size_t i = 0; i < text.size();) {
+    bool matched = false;
+    for (const auto &entity : entities) {
+      size_t length = strlen(entity.first);
+      if (text.compare(i, length, entity.first) == 0) {
+        result += entity.second;
+        i += length;
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) {
+      result += text[i++];
+    }
+  }
+  return result;
+}
+
+//
+// randomValue
+// Up to maxLength bytes of text a browser could send, heavy on the characters
+// that mean something to HTML, JSON or the template engine.
+//
+static std::string randomValue(unsigned int maxLength, bool controlCharacters = false) {
+  static const char special[] = "\"'<>&%\\/:,;= %%";
+  static const char *multiByte[] = { "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x8c\xa1" };
+  std::mt19937 &random = testRandom();
+  unsigned int length = std::uniform_int_distribution<unsigned int>(0, maxLength)(random);
+  std::string value;
+  while (value.size() < length) {
+    switch (random() % 8) {
+      case 0:
+        value += special[random() % (sizeof(special) - 1)];
+        break;
+      case 1: {
+        const char *c = multiByte[random() % std::size(multiByte)];
+        if (value.size() + strlen(c) <= length) {
+          value += c;
+        } else {
+          value += 'x';
+        }
+        break;
+      }
+      case 2:
+        value += controlCharacters ? static_cast<char>(1 + random() % 31) : ' ';
+        break;
+      default:
+        value += static_cast<char>('a' + random() % 26);
+        break;
+    }
+  }
+  return value;
+}
+
+static void postConfig(const std::vector<std::pair<String, String>> &params) {
+  configStatus = String();
+  request(HTTP_POST, "/config", params);
+}
+
+TEST(formAcceptsValuesOfMaxLength) {
+  bootConfigMode(nullptr);
+  std::vector<formField> fields = formFields();
+  CHECK(fields.size() > 0);
+  for (const formField &field : fields) {
+    std::string value(field.maxLength, 'x');
+    postConfig({ { field.key, value.c_str() } });
+    CHECK(configStatus.length() == 0);
+    CHECK(currentValues()[field.key.c_str()] == value);
+  }
+}
+
+TEST(formRejectsWholeSubmissionWithOverlongValue) {
+  bootConfigMode(typicalConfigJson);
+  valueMap before = currentValues();
+  for (const formField &field : formFields()) {
+    std::string value(field.maxLength + 1, 'x');
+    postConfig({ { "hostname", "changed" }, { field.key, value.c_str() } });
+    CHECK(configStatus == "form data rejected");
+    CHECK(currentValues() == before);
+  }
+}
+
+TEST(formRejectsUnknownFields) {
+  bootConfigMode(typicalConfigJson);
+  valueMap before = currentValues();
+  postConfig({ { "hostname", "changed" }, { "notAnItem", "1" } });
+  CHECK(configStatus == "form data rejected");
+  CHECK(currentValues() == before);
+  CHECK(configItems.findItem("notAnItem") < 0);
+  CHECK(configItems.findItem("hostname") == 0);
+}
+
+TEST(formIgnoresQueryParameters) {
+  bootConfigMode(typicalConfigJson);
+  AsyncWebServerRequest req;
+  req.addParam("cacheBuster", "12345", false);
+  req.addParam("hostname", "changed", true);
+  CHECK(configItems.saveResponseValues(&req));
+  CHECK(currentValues()["hostname"] == "changed");
+}
+
+//
+// Random submissions against a model of the rules: any unknown field or
+// overlong value rejects everything, otherwise non-empty values replace the
+// old ones and empty values leave them alone.
+//
+TEST(formSubmissionFuzz) {
+  bootConfigMode(typicalConfigJson);
+  std::vector<formField> fields = formFields();
+  std::mt19937 &random = testRandom();
+  for (int iteration = 0; iteration < 2000; iteration++) {
+    valueMap expected = currentValues();
+    std::vector<std::pair<String, String>> params;
+    bool valid = true;
+    for (const formField &field : fields) {
+      if (random() % 3 == 0) {
+        continue;
+      }
+      //mostly valid lengths, with the boundary and just past it now and then
+      unsigned int limit = random() % 10 == 0 ? field.maxLength + 3 : field.maxLength;
+      std::string value = randomValue(limit);
+      if (random() % 10 == 0) {
+        value = std::string(field.maxLength + random() % 2, 'm');
+      }
+      params.push_back({ field.key, value.c_str() });
+      if (value.size() > field.maxLength) {
+        valid = false;
+      } else if (!value.empty()) {
+        expected[field.key.c_str()] = value;
+      }
+    }
+    if (random() % 20 == 0) {
+      params.push_back({ randomValue(12).c_str(), "x" });
+      valid = valid && configItems.findItem(params.back().first) >= 0;
+    }
+    std::shuffle(params.begin(), params.end(), random);
+    valueMap before = currentValues();
+
+    postConfig(params);
+    REQUIRE(valid == (configStatus.length() == 0));
+    REQUIRE(currentValues() == (valid ? expected : before));
+  }
+}
+
+TEST(loadValuesReportsUnknownKeys) {
+  JsonDocument doc;
+  bootConfigMode(nullptr);
+  CHECK(!deserializeJson(doc, typicalConfigJson));
+  CHECK(configItems.LoadValues(doc));
+
+  doc["retiredSetting"] = "1";
+  configItems.clearValues();
+  CHECK(!configItems.LoadValues(doc));
+  //the known keys still load
+  CHECK(currentValues()["ssid"] == "HomeNetwork");
+}
+
+//
+// Whatever the form accepts comes back unchanged from the config file.
+//
+TEST(jsonRoundTripFuzz) {
+  bootConfigMode(nullptr);
+  std::vector<formField> fields = formFields();
+  for (int iteration = 0; iteration < 500; iteration++) {
+    AsyncWebServerRequest req;
+    configItems.clearValues();
+    for (const formField &field : fields) {
+      req.addParam(field.key, randomValue(field.maxLength, true).c_str());
+    }
+    REQUIRE(configItems.saveResponseValues(&req));
+    valueMap saved = currentValues();
+
+    jsonConfig.clear();
+    configItems.dumpToJson(jsonConfig);
+    REQUIRE(saveConfigFile(CONFIG_FILE));
+    jsonConfig.clear();
+    configItems.clearValues();
+    REQUIRE(loadConfigFile(CONFIG_FILE));
+    REQUIRE(configItems.LoadValues(jsonConfig));
+    REQUIRE(currentValues() == saved);
+  }
+}
+
+//
+// The value the page shows for each item, from the input placeholders and the report table.
+//
+static bool pageValues(const std::string &page, const std::vector<formField> &fields,
+                       valueMap &placeholders, valueMap &reported) {
+  for (const formField &field : fields) {
+    std::string name = std::string("name=\"") + field.key.c_str() + "\"";
+    size_t pos = page.find(name);
+    if (pos == std::string::npos) {
+      return false;
+    }
+    size_t start = page.find("placeholder=\"", pos);
+    size_t end = page.find("\">", start + 13);
+    if (start == std::string::npos || end == std::string::npos) {
+      return false;
+    }
+    placeholders[field.key.c_str()] = htmlUnescape(page.substr(start + 13, end - start - 13));
+  }
+  size_t pos = page.find("To be saved");
+  for (const formField &field : fields) {
+    size_t start = page.find(" <td>", page.find("<tr><td>", pos));
+    size_t end = page.find("<br>\n", start);
+    if (start == std::string::npos || end == std::string::npos) {
+      return false;
+    }
+    reported[field.key.c_str()] = htmlUnescape(page.substr(start + 5, end - start - 5));
+    pos = end;
+  }
+  return true;
+}
+
+TEST(templateSubstitutionFuzz) {
+  bootConfigMode(nullptr);
+  std::vector<formField> fields = formFields();
+  std::mt19937 &random = testRandom();
+  for (int iteration = 0; iteration < 300; iteration++) {
+    AsyncWebServerRequest req;
+    configItems.clearValues();
+    for (const formField &field : fields) {
+      std::string value = randomValue(field.maxLength);
+      if (field.password && random() % 4 != 0) {
+        value = ("Secret-" + value).substr(0, field.maxLength);
+      }
+      req.addParam(field.key, value.c_str());
+    }
+    REQUIRE(configItems.saveResponseValues(&req));
+    valueMap values = currentValues();
+
+    std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/fields.htm");
+    REQUIRE(page->response() != nullptr && page->response()->code == 200);
+    std::string body(page->response()->content.c_str());
+    valueMap placeholders;
+    valueMap reported;
+    REQUIRE(pageValues(body, fields, placeholders, reported));
+    for (const formField &field : fields) {
+      std::string expected = values[field.key.c_str()];
+      if (field.password) {
+        REQUIRE(expected.size() < 7 || body.find(expected) == std::string::npos);
+        expected = expected.empty() ? "" : "********";
+      }
+      REQUIRE(placeholders[field.key.c_str()] == expected);
+      REQUIRE(reported[field.key.c_str()] == expected);
+    }
+  }
+}
+
+TEST(templateRenderTerminates) {
+  bootConfigMode(typicalConfigJson);
+  for (const webAsset &asset : webAssets) {
+    if (!asset.isTemplate) {
+      continue;
+    }
+    bool runaway = true;
+    uncountedString page = renderTemplate(uncountedString(reinterpret_cast<const char *>(asset.data), asset.length),
+                                          processor, 1000, &runaway);
+    CHECK(!runaway);
+    CHECK(page.find("%CONFIG_FIELDS%") == uncountedString::npos);
+  }
+}
+
+TEST(saveUpdatesRunningConfig) {
+  bootConfigMode(typicalConfigJson);
+  postConfig({ { "hostname", "garage-sensor" } });
+  request(HTTP_POST, "/save");
+  CHECK(configStatus == "configuration saved");
+  CHECK(strcmp(devConfig.hostname, "garage-sensor") == 0);
+  CHECK(configReloads == 1);
+  CHECK(loadConfigFile(CONFIG_FILE));
+  CHECK(strcmp(jsonConfig["hostname"] | "", "garage-sensor") == 0);
+}
+
+TEST(saveFailureKeepsRunningConfig) {
+  bootConfigMode(typicalConfigJson);
+  postConfig({ { "hostname", "garage-sensor" } });
+  LittleFS.failWrites = true;
+  request(HTTP_POST, "/save");
+  LittleFS.failWrites = false;
+  CHECK(configStatus == "configuration not saved: filesystem error");
+  CHECK(strcmp(devConfig.hostname, "porch-sensor") == 0);
+  CHECK(configReloads == 0);
+}
+
+TEST(invalidConfigIsNotSaved) {
+  bootConfigMode(typicalConfigJson);
+  postConfig({ { "SampleRateHz", "99" } });
+  request(HTTP_POST, "/save");
+  CHECK(configStatus.startsWith("configuration not saved: SampleRateHz"));
+  CHECK(devConfig.sampleRateHz == 0);
+  CHECK(loadConfigFile(CONFIG_FILE));
+  CHECK(strcmp(jsonConfig["SampleRateHz"] | "", "") == 0);
+}
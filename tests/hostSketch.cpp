@@ -0,0 +1,77 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include "hostSketch.hpp"
+
+AsyncWebServer server(80);
+int configReloads = 0;
+
+void configPublishReload() {
+  configReloads++;
+}
+
+const char *typicalConfigJson =
+  "{\"hostname\":\"porch-sensor\",\"ssid\":\"HomeNetwork\",\"WiFiPw\":\"correct horse battery\","
+  "\"MqttIp\":\"192.168.1.10,192.168.1.11:1884\",\"MqttTlsFingerprint\":\"\",\"MqttUser\":\"sensor\","
+  "\"MqttPw\":\"hunter2\",\"MqttTempTopic\":\"home/porch/temperature\",\"MqttHumTopic\":\"home/porch/humidity\","
+  "\"MqttDiscoveryPrefix\":\"homeassistant\",\"NtpServer\":\"\",\"SampleRateHz\":\"\",\"WindowSeconds\":\"\","
+  "\"RawStream\":\"no\",\"TimestampPayloads\":\"no\"}";
+
+void loadBootConfig(const char *configJson) {
+  String error;
+
+  LittleFS.reset();
+  server.reset();
+  jsonConfig.clear();
+  configItems.clearValues();
+  configFields = String();
+  reportFields = String();
+  configStatus = String();
+  configReloads = 0;
+  clearRuntimeConfig(devConfig);
+
+  fsMounted = LittleFS.begin();
+  if (configJson) {
+    File file = LittleFS.open(CONFIG_FILE, "w");
+    file.write(reinterpret_cast<const uint8_t *>(configJson), strlen(configJson));
+    file.close();
+    if (loadConfigFile(CONFIG_FILE)) {
+      decodeRuntimeConfig(jsonConfig, devConfig, error);
+    }
+  }
+}
+
+void bootConfigMode(const char *configJson) {
+  loadBootConfig(configJson);
+  registerHtmlInterfaces();
+}
+
+std::unique_ptr<AsyncWebServerRequest> request(WebRequestMethod method, const char *uri,
+                                               const std::vector<std::pair<String, String>> &params) {
+  std::unique_ptr<AsyncWebServerRequest> req(new AsyncWebServerRequest());
+  for (const auto &p : params) {
+    req->addParam(p.first, p.second, method == HTTP_POST);
+  }
+  server.handle(method, uri, req.get());
+  return req;
+}
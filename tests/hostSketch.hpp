@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_SKETCH_H_
+#define HOST_SKETCH_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <LittleFS.h>
+
+#include "configItems.hpp"
+#include "runtimeConfig.hpp"
+#include "HtmlRequests.hpp"
+
+//
+// What the .ino and deviceMode.cpp provide to the web/config code,
+// along with the globals the tests need to get at.
+//
+extern AsyncWebServer server;
+extern configurationItems configItems;
+extern String configFields;
+extern String reportFields;
+extern String configStatus;
+extern int configReloads;  //calls to configPublishReload()
+
+//A config with every item set, close to what a deployed unit has
+extern const char *typicalConfigJson;
+
+//
+// loadBootConfig
+// Put everything back to a fresh boot, write configJson (if any) as the config
+// file, then load and decode it the way commonInit() does.
+//
+void loadBootConfig(const char *configJson);
+
+//
+// bootConfigMode
+// loadBootConfig() followed by registerHtmlInterfaces(), as in staConfig mode.
+//
+void bootConfigMode(const char *configJson);
+
+//
+// request
+// Run one request through the registered handlers. params are POST form fields.
+//
+std::unique_ptr<AsyncWebServerRequest> request(WebRequestMethod method, const char *uri,
+                                               const std::vector<std::pair<String, String>> &params = {});
+
+#endif
@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <coredecls.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "hostSketch.hpp"
+#include "testing.hpp"
+#include "webAssets.hpp"
+
+//
+// Tests for serving the embedded web pages and LittleFS overrides of them.
+//
+
+static std::string readFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+static void writeFsFile(const char *path, const std::string &content) {
+  File file = LittleFS.open(path, "w");
+  file.write(reinterpret_cast<const uint8_t *>(content.data()), content.size());
+  file.close();
+}
+
+static bool isStockCrc(const char *path, const std::string &content) {
+  uint32_t crc = crc32(content.data(), content.size());
+  for (const stockAssetCrc &stock : stockAssetCrcs) {
+    if (stock.crc == crc && strcmp(stock.path, path) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static std::string withCrlf(const std::string &text) {
+  std::string result;
+  for (char c : text) {
+    if (c == '\n') {
+      result += '\r';
+    }
+    result += c;
+  }
+  return result;
+}
+
+TEST(webSourcesAreStock) {
+  //fails if web/ changed without rerunning tools/embed_web_assets.py
+  for (const webAsset &asset : webAssets) {
+    std::string source = readFile(std::string(FIXTURE_DIR "/../../web") + asset.path);
+    CHECK(!source.empty());
+    CHECK(isStockCrc(asset.path, source));
+    CHECK(isStockCrc(asset.path, withCrlf(source)));
+  }
+}
+
+TEST(legacyStockPageIsRemoved) {
+  std::string legacy = readFile(FIXTURE_DIR "/legacyIndex.htm");
+  REQUIRE(!legacy.empty());
+  for (const std::string &stockPage : { legacy, withCrlf(legacy) }) {
+    loadBootConfig(typicalConfigJson);
+    writeFsFile("/index.htm", stockPage);
+    registerHtmlInterfaces();
+    CHECK(!LittleFS.exists("/index.htm"));
+    std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/index.htm");
+    REQUIRE(page->response() != nullptr && page->response()->code == 200);
+  }
+}
+
+TEST(editedPageIsAnOverride) {
+  std::string edited = readFile(FIXTURE_DIR "/legacyIndex.htm") + "<!-- local -->\n";
+  loadBootConfig(typicalConfigJson);
+  writeFsFile("/index.htm", edited);
+  registerHtmlInterfaces();
+  CHECK(LittleFS.exists("/index.htm"));
+  std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/index.htm");
+  REQUIRE(page->response() != nullptr && page->response()->code == 200);
+  CHECK(page->response()->body().indexOf("<!-- local -->") >= 0);
+}
+
+TEST(staticPagesAreGzippedAndCached) {
+  bootConfigMode(typicalConfigJson);
+  std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/");
+  REQUIRE(page->response() != nullptr && page->response()->code == 200);
+  CHECK(page->response()->header("Content-Encoding") == "gzip");
+  CHECK(page->response()->header("Cache-Control") == "max-age=604800");
+
+  page = request(HTTP_GET, "/fields.htm");
+  REQUIRE(page->response() != nullptr && page->response()->code == 200);
+  CHECK(page->response()->header("Content-Encoding") == "");
+  CHECK(page->response()->header("Cache-Control") == "no-cache");
+  CHECK(page->response()->body().indexOf("name=\"hostname\"") >= 0);
+  CHECK(page->response()->body().indexOf("%") < 0);
+}
+
+TEST(formPostsRedirectToThePage) {
+  bootConfigMode(typicalConfigJson);
+  for (const char *uri : { "/config", "/reset", "/save" }) {
+    std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_POST, uri);
+    REQUIRE(page->response() != nullptr && page->response()->code == 302);
+    CHECK(page->response()->header("Location") == "/");
+  }
+  std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/fields.htm");
+  CHECK(page->response()->body().indexOf("configuration erased") >= 0);
+}
+
+TEST(formatRecoversFailedMount) {
+  loadBootConfig(nullptr);
+  LittleFS.end();
+  LittleFS.failMount = true;
+  fsMounted = LittleFS.begin();
+  registerHtmlInterfaces();
+
+  std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/fields.htm");
+  CHECK(page->response()->body().indexOf("action=\"format\"") >= 0);
+  request(HTTP_POST, "/config", { { "hostname", "garage-sensor" } });
+  request(HTTP_POST, "/save");
+  CHECK(configStatus == "configuration not saved: filesystem error");
+
+  page = request(HTTP_POST, "/format");
+  CHECK(page->response()->code == 302);
+  CHECK(!fsMounted);
+  loopFormatFs();
+  CHECK(fsMounted && LittleFS.mounted);
+  page = request(HTTP_GET, "/fields.htm");
+  CHECK(page->response()->body().indexOf("action=\"format\"") < 0);
+  CHECK(page->response()->body().indexOf("filesystem formatted") >= 0);
+
+  request(HTTP_POST, "/save");
+  CHECK(configStatus == "configuration saved");
+  CHECK(LittleFS.exists(CONFIG_FILE));
+}
+
+TEST(formatIgnoredWhenMounted) {
+  bootConfigMode(typicalConfigJson);
+  request(HTTP_POST, "/format");
+  loopFormatFs();
+  CHECK(LittleFS.exists(CONFIG_FILE));
+}
@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include "hostSketch.hpp"
+#include "testing.hpp"
+
+//
+// Tests for decoding the config into runtimeConfig.
+//
+
+static bool decode(JsonDocument &doc, runtimeConfig &config, String &error) {
+  error = String();
+  return decodeRuntimeConfig(doc, config, error);
+}
+
+TEST(brokerListParsing) {
+  static const struct {
+    const char *list;
+    bool valid;
+    uint8_t count;
+    uint16_t lastPort;
+  } cases[] = {
+    { "", true, 0, 0 },
+    { "192.168.1.10", true, 1, MQTT_PORT },
+    { " 192.168.1.10 , 10.0.0.2:1884 ", true, 2, 1884 },
+    { "1.2.3.4,1.2.3.5,1.2.3.6,1.2.3.7", true, 4, MQTT_PORT },
+    { "1.2.3.4,1.2.3.5,1.2.3.6,1.2.3.7,1.2.3.8", false, 0, 0 },
+    { "1.2.3.4:0", false, 0, 0 },
+    { "1.2.3.4:65536", false, 0, 0 },
+    { "1.2.3.4:abc", false, 0, 0 },
+    { "1.2.3.4:80x", false, 0, 0 },
+    { "1.2.3.4:1883abc", false, 0, 0 },
+    { "1.2.3.4:", false, 0, 0 },
+    { "1.2.3.4:+1883", false, 0, 0 },
+    { "1.2.3.4: 1883", false, 0, 0 },
+    { "1.2.3.4:4294968179", false, 0, 0 },
+    { "1.2.3.4:01883", true, 1, 1883 },
+    { "1.2.3", false, 0, 0 },
+    { "broker.local", false, 0, 0 },
+    { "1.2.3.4,", false, 0, 0 },
+  };
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+  for (const auto &c : cases) {
+    doc["MqttIp"] = c.list;
+    CHECK(decode(doc, config, error) == c.valid);
+    if (c.valid) {
+      CHECK(config.brokerCount == c.count);
+      CHECK(c.count == 0 || config.brokers[c.count - 1].port == c.lastPort);
+    } else {
+      CHECK(error.length() > 0);
+      //the message quotes the bad entry
+      CHECK(error.indexOf("MQTT broker") >= 0 || error.indexOf("at most") >= 0);
+    }
+  }
+}
+
+TEST(brokerListFuzz) {
+  static const char alphabet[] = "0123456789..,,:: ";
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+  std::mt19937 &random = testRandom();
+  for (int iteration = 0; iteration < 5000; iteration++) {
+    std::string list;
+    unsigned int length = random() % 64;
+    while (list.size() < length) {
+      list += alphabet[random() % (sizeof(alphabet) - 1)];
+    }
+    doc["MqttIp"] = list.c_str();
+    if (decode(doc, config, error)) {
+      REQUIRE(config.brokerCount <= MAX_MQTT_BROKERS);
+      for (int i = 0; i < config.brokerCount; i++) {
+        REQUIRE(config.brokers[i].port != 0);
+      }
+    } else {
+      REQUIRE(error.length() > 0);
+    }
+  }
+}
+
+//
+// Every item's buffer in runtimeConfig has room for the longest value the form allows.
+//
+TEST(configBuffersHoldMaxLengthValues) {
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+  bootConfigMode(nullptr);
+  int pos = 0;
+  int fields = 0;
+  while ((pos = configFields.indexOf("name=\"", pos)) >= 0) {
+    pos += 6;
+    String key = configFields.substring(pos, configFields.indexOf('"', pos));
+    int maxLength = configFields.indexOf("maxlength=\"", pos) + 11;
+    std::string value(configFields.substring(maxLength, configFields.indexOf('"', maxLength)).toInt(), 'a');
+    doc.clear();
+    doc[key] = value.c_str();
+    decode(doc, config, error);
+    CHECK(error != key + " is too long");
+    fields++;
+  }
+  CHECK(fields > 0);
+}
+
+TEST(numberRanges) {
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+
+  doc["SampleRateHz"] = "10";
+  doc["WindowSeconds"] = " 3600 ";
+  CHECK(decode(doc, config, error));
+  CHECK(config.sampleRateHz == 10 && config.windowSeconds == 3600);
+  doc["SampleRateHz"] = "11";
+  CHECK(!decode(doc, config, error));
+  doc["SampleRateHz"] = "-1";
+  CHECK(!decode(doc, config, error));
+  doc["SampleRateHz"] = "";
+  doc["WindowSeconds"] = "";
+  CHECK(decode(doc, config, error));
+  CHECK(config.sampleRateHz == 0 && config.windowSeconds == DEFAULT_WINDOW_SECONDS);
+  doc["WindowSeconds"] = "0";
+  CHECK(!decode(doc, config, error));
+}
+
+TEST(tlsFingerprint) {
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+
+  doc["MqttIp"] = "10.0.0.2";
+  doc["MqttTlsFingerprint"] = "01:23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:67";
+  CHECK(decode(doc, config, error));
+  CHECK(config.useTls && config.brokers[0].port == MQTT_TLS_PORT);
+  CHECK(config.tlsFingerprint[0] == 0x01 && config.tlsFingerprint[6] == 0xcd && config.tlsFingerprint[13] == 0xab && config.tlsFingerprint[19] == 0x67);
+
+  //formats setFingerprint(const char*) takes
+  static const char *accepted[] = {
+    "0123456789abcdef0123456789ABCDEF01234567",
+    "01 23 45 67 89 ab cd ef 01 23 45 67 89 AB CD EF 01 23 45 67",
+    "01: 23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:67: ",
+  };
+  for (const char *fingerprint : accepted) {
+    doc["MqttTlsFingerprint"] = fingerprint;
+    CHECK(decode(doc, config, error) && config.useTls);
+    CHECK(config.tlsFingerprint[6] == 0xcd && config.tlsFingerprint[13] == 0xab);
+  }
+  static const char *rejected[] = {
+    "01:23:45",
+    "01-23-45-67-89-ab-cd-ef-01-23-45-67-89-AB-CD-EF-01-23-45-67",
+    "0:12:34:56:78:9a:bc:de:f0:12:34:56:78:9A:BC:DE:F0:12:34:56:7",
+    " 01:23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:67",
+    "01:23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:67:89",
+    "01:23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:6g",
+    "01:23:45:67:89:ab:cd:ef:01:23:45:67:89:AB:CD:EF:01:23:45:6",
+  };
+  for (const char *fingerprint : rejected) {
+    doc["MqttTlsFingerprint"] = fingerprint;
+    CHECK(!decode(doc, config, error));
+  }
+}
+
+TEST(discoveryHashFollowsInputs) {
+  JsonDocument doc;
+  runtimeConfig config;
+  String error;
+
+  CHECK(!deserializeJson(doc, typicalConfigJson));
+  CHECK(decode(doc, config, error));
+  uint32_t hash = config.discoveryHash;
+  CHECK(hash != 0);
+  CHECK(decode(doc, config, error) && config.discoveryHash == hash);
+
+  //only what goes into the documents matters
+  doc["ssid"] = "OtherNetwork";
+  CHECK(decode(doc, config, error) && config.discoveryHash == hash);
+  doc["MqttTempTopic"] = "home/porch/temp";
+  CHECK(decode(doc, config, error) && config.discoveryHash != hash);
+  doc["MqttTempTopic"] = "home/porch/temperature";
+  doc["hostname"] = "porch";
+  CHECK(decode(doc, config, error) && config.discoveryHash != hash);
+  doc["hostname"] = "porch-sensor";
+  //the value_template depends on the payload format
+  doc["TimestampPayloads"] = "yes";
+  CHECK(decode(doc, config, error) && config.timestampPayloads && config.discoveryHash != hash);
+  doc["TimestampPayloads"] = "no";
+  CHECK(decode(doc, config, error) && !config.timestampPayloads && config.discoveryHash == hash);
+  //the high rate mode points the entities at the window summaries
+  doc["SampleRateHz"] = "2";
+  CHECK(decode(doc, config, error) && config.discoveryHash != hash);
+  doc["SampleRateHz"] = "";
+
+  doc["MqttDiscoveryPrefix"] = "";
+  CHECK(decode(doc, config, error) && config.discoveryHash == 0);
+  doc["MqttDiscoveryPrefix"] = "homeassistant";
+  doc["MqttTempTopic"] = "";
+  doc["MqttHumTopic"] = "";
+  CHECK(decode(doc, config, error) && config.discoveryHash == 0);
+}
@@ -0,0 +1,127 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+//
+// Host build stand-in for the ESP8266 Arduino core.
+// Just enough of the core for the web/config code to build and run as a
+// normal program.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "WString.h"
+
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+
+//
+// Print
+// Output goes nowhere unless SERIAL_LOG is set in the environment, so the
+// tests and benchmarks aren't dominated by logging.
+//
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  size_t print(const String &s) { return write(reinterpret_cast<const uint8_t *>(s.c_str()), s.length()); }
+  size_t print(const char *s) { return write(reinterpret_cast<const uint8_t *>(s), strlen(s)); }
+  size_t print(const __FlashStringHelper *s) { return print(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(unsigned char n, int base = 10) { return print(String(n, base)); }
+  size_t print(int n, int base = 10) { return print(String(n, base)); }
+  size_t print(unsigned int n, int base = 10) { return print(String(n, base)); }
+  size_t print(long n, int base = 10) { return print(String(n, base)); }
+  size_t print(unsigned long n, int base = 10) { return print(String(n, base)); }
+  size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+
+  template <typename T>
+  size_t println(const T &value) { return print(value) + println(); }
+  size_t println() { return print("\r\n"); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+//
+// EspClass
+// The heap numbers come from the allocation counter (see allocCounter.hpp)
+// against a nominal amount of free heap, so heapStats reports something useful.
+//
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation() { return 0; }
+  uint32_t getChipId() { return 0x00c0ffee; }
+  void restart() { restartRequested = true; }
+
+  bool restartRequested = false;
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,368 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <ArduinoJson.h>
+
+JsonMemberProxy &JsonMemberProxy::operator=(const String &value) {
+  doc.set(key, value.c_str(), value.length(), true);
+  return *this;
+}
+
+JsonMemberProxy &JsonMemberProxy::operator=(const char *value) {
+  doc.set(key, value, strlen(value), true);
+  return *this;
+}
+
+const char *JsonMemberProxy::operator|(const char *defaultValue) const {
+  const JsonMember *m = doc.find(key);
+  return m && m->isString ? m->value.c_str() : defaultValue;
+}
+
+JsonMemberProxy::operator String() const {
+  const JsonMember *m = doc.find(key);
+  if (!m) {
+    return String("null");
+  }
+  return String(m->value.c_str(), m->value.size());
+}
+
+bool JsonMemberProxy::isNull() const {
+  const JsonMember *m = doc.find(key);
+  return !m || (!m->isString && m->value == "null");
+}
+
+const JsonMember *JsonDocument::find(const char *key) const {
+  for (const JsonMember &m : members) {
+    if (m.key == key) {
+      return &m;
+    }
+  }
+  return nullptr;
+}
+
+void JsonDocument::set(const char *key, const char *value, size_t length, bool isString) {
+  isObject = true;
+  for (JsonMember &m : members) {
+    if (m.key == key) {
+      m.value.assign(value, length);
+      m.isString = isString;
+      return;
+    }
+  }
+  members.push_back({ key, std::string(value, length), isString });
+}
+
+void JsonDocument::clear() {
+  members.clear();
+  isObject = false;
+}
+
+const char *DeserializationError::c_str() const {
+  switch (code) {
+    case Ok:
+      return "Ok";
+    case EmptyInput:
+      return "EmptyInput";
+    case IncompleteInput:
+      return "IncompleteInput";
+    default:
+      return "InvalidInput";
+  }
+}
+
+//
+// Parser for a flat object. Nested values aren't used by the config file.
+//
+namespace {
+
+class jsonParser {
+public:
+  jsonParser(const char *text, size_t length) : p(text), end(text + length) {}
+
+  DeserializationError::Code parse(JsonDocument &doc) {
+    doc.clear();
+    skipSpace();
+    if (p == end) {
+      return DeserializationError::EmptyInput;
+    }
+    if (*p != '{') {
+      return DeserializationError::InvalidInput;
+    }
+    p++;
+    bool first = true;
+    std::vector<JsonMember> members;
+    for (;;) {
+      skipSpace();
+      if (p == end) {
+        return DeserializationError::IncompleteInput;
+      }
+      if (*p == '}') {
+        p++;
+        break;
+      }
+      if (!first) {
+        if (*p != ',') {
+          return DeserializationError::InvalidInput;
+        }
+        p++;
+        skipSpace();
+      }
+      first = false;
+      std::string key;
+      DeserializationError::Code code = parseString(key);
+      if (code != DeserializationError::Ok) {
+        return code;
+      }
+      skipSpace();
+      if (p == end) {
+        return DeserializationError::IncompleteInput;
+      }
+      if (*p != ':') {
+        return DeserializationError::InvalidInput;
+      }
+      p++;
+      skipSpace();
+      if (p == end) {
+        return DeserializationError::IncompleteInput;
+      }
+      JsonMember member{ key, std::string(), *p == '"' };
+      code = member.isString ? parseString(member.value) : parseScalar(member.value);
+      if (code != DeserializationError::Ok) {
+        return code;
+      }
+      members.push_back(member);
+    }
+    //an empty object is still an object
+    doc.setObject();
+    for (const JsonMember &m : members) {
+      doc.set(m.key.c_str(), m.value.data(), m.value.size(), m.isString);
+    }
+    return DeserializationError::Ok;
+  }
+
+private:
+  void skipSpace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+      p++;
+    }
+  }
+
+  static void appendUtf8(std::string &out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+      out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+      out += static_cast<char>(0xc0 | (codepoint >> 6));
+      out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    } else if (codepoint < 0x10000) {
+      out += static_cast<char>(0xe0 | (codepoint >> 12));
+      out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    } else {
+      out += static_cast<char>(0xf0 | (codepoint >> 18));
+      out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    }
+  }
+
+  bool parseHex4(uint32_t &value) {
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      if (p == end || !isxdigit(static_cast<unsigned char>(*p))) {
+        return false;
+      }
+      char c = *p++;
+      value = value * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+    }
+    return true;
+  }
+
+  DeserializationError::Code parseString(std::string &out) {
+    if (*p != '"') {
+      return DeserializationError::InvalidInput;
+    }
+    p++;
+    while (p < end && *p != '"') {
+      if (*p != '\\') {
+        out += *p++;
+        continue;
+      }
+      p++;
+      if (p == end) {
+        return DeserializationError::IncompleteInput;
+      }
+      char c = *p++;
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          out += c;
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u': {
+          uint32_t codepoint;
+          if (!parseHex4(codepoint)) {
+            return DeserializationError::InvalidInput;
+          }
+          if (codepoint >= 0xd800 && codepoint < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+            p += 2;
+            uint32_t low;
+            if (!parseHex4(low)) {
+              return DeserializationError::InvalidInput;
+            }
+            codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+          }
+          appendUtf8(out, codepoint);
+          break;
+        }
+        default:
+          return DeserializationError::InvalidInput;
+      }
+    }
+    if (p == end) {
+      return DeserializationError::IncompleteInput;
+    }
+    p++;
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError::Code parseScalar(std::string &out) {
+    while (p < end && (isalnum(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' || *p == '.')) {
+      out += *p++;
+    }
+    if (out.empty() || *p == '{' || *p == '[') {
+      return DeserializationError::InvalidInput;
+    }
+    return DeserializationError::Ok;
+  }
+
+  const char *p;
+  const char *end;
+};
+
+void writeString(std::string &out, const std::string &value) {
+  static const char hex[] = "0123456789abcdef";
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += hex[c >> 4];
+          out += hex[c & 0xf];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+std::string serialize(const JsonDocument &doc) {
+  if (doc.isNull()) {
+    return "null";
+  }
+  std::string out = "{";
+  bool first = true;
+  for (const JsonMember &m : doc.allMembers()) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    writeString(out, m.key);
+    out += ':';
+    if (m.isString) {
+      writeString(out, m.value);
+    } else {
+      out += m.value;
+    }
+  }
+  out += '}';
+  return out;
+}
+
+}  // namespace
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length) {
+  return jsonParser(input, length).parse(doc);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const String &input) {
+  return deserializeJson(doc, input.c_str(), input.length());
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, File &input) {
+  std::string text;
+  uint8_t buffer[64];
+  size_t length;
+  while ((length = input.read(buffer, sizeof(buffer))) > 0) {
+    text.append(reinterpret_cast<const char *>(buffer), length);
+  }
+  return deserializeJson(doc, text.data(), text.size());
+}
+
+size_t serializeJson(const JsonDocument &doc, String &output) {
+  std::string text = serialize(doc);
+  output = String(text.data(), text.size());
+  return text.size();
+}
+
+size_t serializeJson(const JsonDocument &doc, File &output) {
+  std::string text = serialize(doc);
+  return output.write(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+}
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_ARDUINOJSON_H_
+#define HOST_ARDUINOJSON_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <string>
+#include <utility>
+
+//
+// Host build stand-in for the parts of ArduinoJson 7 the config code uses.
+// The config file is a flat object of strings so that's all this handles;
+// other scalar values are kept as their JSON text.
+//
+
+class JsonDocument;
+
+struct JsonMember {
+  std::string key;
+  std::string value;
+  bool isString;
+};
+
+class JsonString {
+public:
+  explicit JsonString(const char *text) : text(text) {}
+  const char *c_str() const { return text; }
+
+private:
+  const char *text;
+};
+
+class JsonPair {
+public:
+  explicit JsonPair(const std::string &key) : keyText(key) {}
+  JsonString key() const { return JsonString(keyText.c_str()); }
+
+private:
+  const std::string &keyText;
+};
+
+class JsonObject {
+public:
+  typedef std::vector<JsonMember>::const_iterator memberIterator;
+
+  class iterator {
+  public:
+    explicit iterator(memberIterator it) : it(it) {}
+    JsonPair operator*() const { return JsonPair(it->key); }
+    iterator &operator++() {
+      ++it;
+      return *this;
+    }
+    bool operator!=(const iterator &rhs) const { return it != rhs.it; }
+
+  private:
+    memberIterator it;
+  };
+
+  JsonObject(memberIterator first, memberIterator last) : first(first), last(last) {}
+  iterator begin() const { return iterator(first); }
+  iterator end() const { return iterator(last); }
+
+private:
+  memberIterator first;
+  memberIterator last;
+};
+
+//
+// Result of doc[key]. Reads give the value (or the default for a missing or
+// non-string member), assignment adds or replaces the member.
+//
+class JsonMemberProxy {
+public:
+  JsonMemberProxy(JsonDocument &doc, const char *key) : doc(doc), key(key) {}
+
+  JsonMemberProxy &operator=(const String &value);
+  JsonMemberProxy &operator=(const char *value);
+  const char *operator|(const char *defaultValue) const;
+  explicit operator String() const;
+  bool isNull() const;
+
+private:
+  JsonDocument &doc;
+  const char *key;
+};
+
+class JsonDocument {
+public:
+  JsonMemberProxy operator[](const String &key) { return JsonMemberProxy(*this, key.c_str()); }
+  JsonMemberProxy operator[](const char *key) { return JsonMemberProxy(*this, key); }
+  bool containsKey(const String &key) const { return find(key.c_str()) != nullptr; }
+  bool containsKey(const char *key) const { return find(key) != nullptr; }
+  bool isNull() const { return !isObject; }
+  size_t size() const { return members.size(); }
+  void clear();
+  void shrinkToFit() { members.shrink_to_fit(); }
+
+  template <typename T>
+  T as() const;
+
+  //host only
+  const JsonMember *find(const char *key) const;
+  void set(const char *key, const char *value, size_t length, bool isString);
+  void setObject() { isObject = true; }
+  const std::vector<JsonMember> &allMembers() const { return members; }
+
+private:
+  std::vector<JsonMember> members;
+  bool isObject = false;
+};
+
+template <>
+inline JsonObject JsonDocument::as<JsonObject>() const {
+  return JsonObject(members.begin(), members.end());
+}
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput };
+
+  DeserializationError(Code code) : code(code) {}
+  explicit operator bool() const { return code != Ok; }
+  bool operator==(Code rhs) const { return code == rhs; }
+  const char *c_str() const;
+  const char *f_str() const { return c_str(); }
+
+private:
+  Code code;
+};
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length);
+DeserializationError deserializeJson(JsonDocument &doc, const String &input);
+DeserializationError deserializeJson(JsonDocument &doc, File &input);
+size_t serializeJson(const JsonDocument &doc, String &output);
+size_t serializeJson(const JsonDocument &doc, File &output);
+
+#endif
@@ -0,0 +1,156 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <ESPAsyncWebServer.h>
+
+String AsyncWebServerResponse::header(const String &name) const {
+  for (const auto &h : headers) {
+    if (h.first.equalsIgnoreCase(name)) {
+      return h.second;
+    }
+  }
+  return String();
+}
+
+const AsyncWebParameter *AsyncWebServerRequest::getParam(size_t num) const {
+  return num < _params.size() ? &_params[num] : nullptr;
+}
+
+const AsyncWebParameter *AsyncWebServerRequest::getParam(const String &name, bool post, bool file) const {
+  for (const AsyncWebParameter &p : _params) {
+    if (p.name() == name && p.isPost() == post && p.isFile() == file) {
+      return &p;
+    }
+  }
+  return nullptr;
+}
+
+void AsyncWebServerRequest::send(int code, const String &contentType, const String &content) {
+  send(new AsyncWebServerResponse(code, contentType, uncountedString(content.c_str(), content.length())));
+}
+
+void AsyncWebServerRequest::send(FS &fs, const String &path, const String &contentType, bool download,
+                                 AwsTemplateProcessor callback) {
+  send(beginResponse(fs, path, contentType, download, callback));
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse(FS &fs, const String &path, const String &contentType,
+                                                             bool download, AwsTemplateProcessor callback) {
+  (void)download;
+  File file = fs.open(path, "r");
+  if (!file) {
+    return new AsyncWebServerResponse(404, String(), uncountedString());
+  }
+  uncountedString content;
+  int c;
+  while ((c = file.read()) >= 0) {
+    content += static_cast<char>(c);
+  }
+  return new AsyncWebServerResponse(200, contentType, callback ? renderTemplate(content, callback) : content);
+}
+
+void AsyncWebServerRequest::send_P(int code, const String &contentType, const uint8_t *content, size_t len,
+                                   AwsTemplateProcessor callback) {
+  send(beginResponse_P(code, contentType, content, len, callback));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String &contentType, PGM_P content, AwsTemplateProcessor callback) {
+  send_P(code, contentType, reinterpret_cast<const uint8_t *>(content), strlen(content), callback);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse_P(int code, const String &contentType,
+                                                               const uint8_t *content, size_t len,
+                                                               AwsTemplateProcessor callback) {
+  uncountedString text(reinterpret_cast<const char *>(content), len);
+  return new AsyncWebServerResponse(code, contentType, callback ? renderTemplate(text, callback) : text);
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse *response) {
+  _response.reset(response);
+}
+
+void AsyncWebServerRequest::redirect(const String &url) {
+  AsyncWebServerResponse *response = new AsyncWebServerResponse(302, String(), uncountedString());
+  response->addHeader("Location", url);
+  send(response);
+}
+
+void AsyncWebServer::on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest) {
+  routes.push_back({ uri, method, onRequest });
+}
+
+bool AsyncWebServer::handle(WebRequestMethodComposite method, const char *uri, AsyncWebServerRequest *request) {
+  for (const route &r : routes) {
+    if ((r.method & method) && r.uri == uri) {
+      r.handler(request);
+      return true;
+    }
+  }
+  if (notFoundHandler) {
+    notFoundHandler(request);
+  }
+  return false;
+}
+
+void AsyncWebServer::reset() {
+  routes.clear();
+  notFoundHandler = nullptr;
+}
+
+uncountedString renderTemplate(uncountedString page, AwsTemplateProcessor callback, size_t maxSubstitutions,
+                               bool *runaway) {
+  size_t pos = 0;
+  size_t substitutions = 0;
+
+  if (runaway) {
+    *runaway = false;
+  }
+  for (;;) {
+    size_t start = page.find(TEMPLATE_PLACEHOLDER, pos);
+    if (start == uncountedString::npos) {
+      break;
+    }
+    size_t end = page.find(TEMPLATE_PLACEHOLDER, start + 1);
+    if (end == uncountedString::npos) {
+      break;
+    }
+    size_t nameLength = std::min<size_t>(TEMPLATE_PARAM_NAME_LENGTH, end - start - 1);
+    if (nameLength == 0) {
+      //"%%", keep one and carry on after it
+      page.erase(end, 1);
+      pos = start + 1;
+      continue;
+    }
+    if (++substitutions > maxSubstitutions) {
+      if (runaway) {
+        *runaway = true;
+      }
+      break;
+    }
+    String value = callback(String(page.data() + start + 1, nameLength));
+    page.replace(start, end - start + 1, value.c_str(), value.length());
+    //the library doesn't move past the value, so it gets scanned too
+    pos = start;
+  }
+  return page;
+}
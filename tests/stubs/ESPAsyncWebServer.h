@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_ESPASYNCWEBSERVER_H_
+#define HOST_ESPASYNCWEBSERVER_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "allocCounter.hpp"
+
+//
+// Host build stand-in for ESPAsyncWebServer.
+// Requests are built by the test, handlers are called directly and the
+// response is kept on the request so it can be checked. Template pages are
+// rendered the same way the library does it (see renderTemplate()).
+// The library streams a response through a fixed buffer, so the rendered
+// content is kept out of the allocation counts. What the processor returns
+// is still counted since the device allocates that too.
+//
+
+#define TEMPLATE_PLACEHOLDER '%'
+#define TEMPLATE_PARAM_NAME_LENGTH 32
+
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerRequest;
+typedef std::function<String(const String &)> AwsTemplateProcessor;
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String &name, const String &value, bool form = false, bool file = false)
+    : _name(name), _value(value), _isForm(form), _isFile(file) {}
+  const String &name() const { return _name; }
+  const String &value() const { return _value; }
+  bool isPost() const { return _isForm; }
+  bool isFile() const { return _isFile; }
+
+private:
+  String _name;
+  String _value;
+  bool _isForm;
+  bool _isFile;
+};
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const String &contentType, uncountedString content)
+    : code(code), contentType(contentType), content(std::move(content)) {}
+  void addHeader(const String &name, const String &value) { headers.push_back({ name, value }); }
+  String header(const String &name) const;
+  String body() const { return String(content.data(), content.size()); }
+
+  int code;
+  String contentType;
+  uncountedString content;  //after template processing
+  std::vector<std::pair<String, String>> headers;
+};
+
+class AsyncWebServerRequest {
+public:
+  size_t params() const { return _params.size(); }
+  const AsyncWebParameter *getParam(size_t num) const;
+  const AsyncWebParameter *getParam(const String &name, bool post = false, bool file = false) const;
+  bool hasParam(const String &name, bool post = false, bool file = false) const {
+    return getParam(name, post, file) != nullptr;
+  }
+
+  void send(int code, const String &contentType = String(), const String &content = String());
+  void send(FS &fs, const String &path, const String &contentType = String(), bool download = false,
+            AwsTemplateProcessor callback = nullptr);
+  void send_P(int code, const String &contentType, const uint8_t *content, size_t len,
+              AwsTemplateProcessor callback = nullptr);
+  void send_P(int code, const String &contentType, PGM_P content, AwsTemplateProcessor callback = nullptr);
+  AsyncWebServerResponse *beginResponse(FS &fs, const String &path, const String &contentType = String(),
+                                        bool download = false, AwsTemplateProcessor callback = nullptr);
+  AsyncWebServerResponse *beginResponse_P(int code, const String &contentType, const uint8_t *content, size_t len,
+                                          AwsTemplateProcessor callback = nullptr);
+  void send(AsyncWebServerResponse *response);
+  void redirect(const String &url);
+
+  //host only
+  void addParam(const String &name, const String &value, bool post = true) { _params.emplace_back(name, value, post); }
+  AsyncWebServerResponse *response() const { return _response.get(); }
+
+private:
+  std::vector<AsyncWebParameter> _params;
+  std::unique_ptr<AsyncWebServerResponse> _response;
+};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) { (void)port; }
+  void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+  void onNotFound(ArRequestHandlerFunction fn) { notFoundHandler = fn; }
+  void begin() {}
+
+  //host only
+  bool handle(WebRequestMethodComposite method, const char *uri, AsyncWebServerRequest *request);
+  void reset();
+
+private:
+  struct route {
+    String uri;
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction handler;
+  };
+  std::vector<route> routes;
+  ArRequestHandlerFunction notFoundHandler;
+};
+
+//
+// renderTemplate
+// Substitute %NAME% placeholders the way AsyncAbstractResponse does:
+// - the text between two '%' is the name, cut to TEMPLATE_PARAM_NAME_LENGTH,
+//   and the whole span is replaced by what the processor returns
+// - the replacement is scanned again, so values can hold placeholders
+// - "%%" is a single '%'
+// - a '%' with no closing '%' is left as is
+// Stops after maxSubstitutions so a value that expands to itself can't hang a test;
+// *runaway is set if that happened.
+//
+uncountedString renderTemplate(uncountedString page, AwsTemplateProcessor callback,
+                               size_t maxSubstitutions = 10000, bool *runaway = nullptr);
+
+#endif
@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <FS.h>
+#include <LittleFS.h>
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t length) {
+  if (!data || position >= data->size()) {
+    return 0;
+  }
+  length = std::min(length, data->size() - position);
+  memcpy(buffer, data->data() + position, length);
+  position += length;
+  return length;
+}
+
+size_t File::write(const uint8_t *buffer, size_t length) {
+  if (!data || !writable || LittleFS.failWrites) {
+    return 0;
+  }
+  data->append(reinterpret_cast<const char *>(buffer), length);
+  return length;
+}
+
+bool FS::begin() {
+  mounted = !failMount;
+  return mounted;
+}
+
+bool FS::format() {
+  files.clear();
+  failMount = false;
+  return true;
+}
+
+bool FS::exists(const char *path) const {
+  return mounted && files.count(path) > 0;
+}
+
+bool FS::remove(const char *path) {
+  return mounted && files.erase(path) > 0;
+}
+
+File FS::open(const char *path, const char *mode) {
+  if (!mounted) {
+    return File();
+  }
+  auto it = files.find(path);
+  if (mode[0] == 'r') {
+    return it == files.end() ? File() : File(it->second, false, path);
+  }
+  if (it == files.end() || mode[0] == 'w') {
+    //a fresh buffer so files already open for reading are left alone
+    it = files.insert_or_assign(path, std::make_shared<std::string>()).first;
+  }
+  return File(it->second, true, path);
+}
+
+void FS::reset() {
+  files.clear();
+  mounted = false;
+  failMount = false;
+  failWrites = false;
+}
+
+FS LittleFS;
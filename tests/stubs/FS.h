@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_FS_H_
+#define HOST_FS_H_
+
+#include <Arduino.h>
+
+#include <map>
+#include <string>
+
+//
+// Host build stand-in for the core's FS/File, backed by memory.
+// Tests can make the mount or writes fail to exercise the error paths.
+//
+class File {
+public:
+  File() {}
+  File(std::shared_ptr<std::string> data, bool writable, const char *name)
+    : data(data), writable(writable), fileName(name) {}
+
+  explicit operator bool() const { return data != nullptr; }
+  size_t size() const { return data ? data->size() : 0; }
+  int available() const { return data ? static_cast<int>(data->size() - position) : 0; }
+  int read();
+  size_t read(uint8_t *buffer, size_t length);
+  size_t write(const uint8_t *buffer, size_t length);
+  size_t write(uint8_t c) { return write(&c, 1); }
+  const char *name() const { return fileName.c_str(); }
+  void close() { data.reset(); }
+
+private:
+  std::shared_ptr<std::string> data;
+  bool writable = false;
+  size_t position = 0;
+  String fileName;
+};
+
+class FS {
+public:
+  bool begin();
+  void end() { mounted = false; }
+  bool format();
+  bool exists(const String &path) const { return exists(path.c_str()); }
+  bool exists(const char *path) const;
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool remove(const char *path);
+  File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+  File open(const char *path, const char *mode);
+
+  //host only
+  void reset();
+  bool mounted = false;
+  bool failMount = false;   //begin() fails until format() is called
+  bool failWrites = false;  //writes to open files are dropped
+  std::map<std::string, std::shared_ptr<std::string>> files;
+};
+
+#endif
@@ -0,0 +1,445 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "WString.h"
+
+String::String() : heap(nullptr), heapCapacity(0), len(0) {
+  sso[0] = 0;
+}
+
+String::String(const char *cstr) : String() {
+  if (cstr) {
+    copy(cstr, strlen(cstr));
+  }
+}
+
+String::String(const char *cstr, unsigned int length) : String() {
+  if (cstr) {
+    copy(cstr, length);
+  }
+}
+
+String::String(const String &str) : String() {
+  copy(str.buffer(), str.len);
+}
+
+String::String(String &&rval) noexcept : String() {
+  move(rval);
+}
+
+String::String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+String::String(char c) : String() {
+  concat(c);
+}
+
+String::String(unsigned char value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+String::String(int value, unsigned char base) : String(static_cast<long>(value), base) {}
+String::String(unsigned int value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base) : String() {
+  if (base == 10) {
+    concat(value);
+  } else {
+    concat(static_cast<unsigned long>(value) ? String(static_cast<unsigned long>(value), base) : String("0"));
+  }
+}
+
+String::String(unsigned long value, unsigned char base) : String() {
+  char digits[8 * sizeof(value) + 1];
+  char *p = &digits[sizeof(digits) - 1];
+  *p = 0;
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    unsigned long digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value);
+  concat(p);
+}
+
+String::String(long long value, unsigned char base) : String(static_cast<long>(value), base) {}
+String::String(unsigned long long value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(float value, unsigned char decimalPlaces) : String(static_cast<double>(value), decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces) : String() {
+  concatNumber("%.*f", static_cast<int>(decimalPlaces), value);
+}
+
+String::~String() {
+  invalidate();
+}
+
+void String::invalidate() {
+  free(heap);
+  heap = nullptr;
+  heapCapacity = 0;
+  len = 0;
+  sso[0] = 0;
+}
+
+//
+// Same policy as the core: short strings live inline, anything longer gets a
+// heap buffer rounded up to the next 16 bytes.
+//
+bool String::changeBuffer(unsigned int maxStrLen) {
+  if (maxStrLen <= SSO_CAPACITY) {
+    if (heap) {
+      memcpy(sso, heap, len + 1);
+      free(heap);
+      heap = nullptr;
+      heapCapacity = 0;
+    }
+    return true;
+  }
+  size_t newSize = (maxStrLen + 16) & ~static_cast<size_t>(0xf);
+  char *newBuffer = static_cast<char *>(realloc(heap, newSize));
+  if (!newBuffer) {
+    return false;
+  }
+  if (!heap) {
+    memcpy(newBuffer, sso, len + 1);
+  }
+  heap = newBuffer;
+  heapCapacity = newSize - 1;
+  return true;
+}
+
+bool String::reserve(unsigned int size) {
+  if (capacity() >= size) {
+    return true;
+  }
+  return changeBuffer(size);
+}
+
+String &String::copy(const char *cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  memmove(wbuffer(), cstr, length);
+  len = length;
+  wbuffer()[len] = 0;
+  return *this;
+}
+
+void String::move(String &rhs) noexcept {
+  free(heap);
+  heap = rhs.heap;
+  heapCapacity = rhs.heapCapacity;
+  len = rhs.len;
+  if (!heap) {
+    memcpy(sso, rhs.sso, len + 1);
+  }
+  rhs.heap = nullptr;
+  rhs.heapCapacity = 0;
+  rhs.len = 0;
+  rhs.sso[0] = 0;
+}
+
+String &String::operator=(const String &rhs) {
+  if (this != &rhs) {
+    copy(rhs.buffer(), rhs.len);
+  }
+  return *this;
+}
+
+String &String::operator=(String &&rval) noexcept {
+  if (this != &rval) {
+    move(rval);
+  }
+  return *this;
+}
+
+String &String::operator=(const char *cstr) {
+  if (!cstr) {
+    invalidate();
+    return *this;
+  }
+  return copy(cstr, strlen(cstr));
+}
+
+String &String::operator=(const __FlashStringHelper *str) {
+  return *this = reinterpret_cast<const char *>(str);
+}
+
+String &String::operator=(char c) {
+  return copy(&c, 1);
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+  if (!cstr) {
+    return false;
+  }
+  if (length == 0) {
+    return true;
+  }
+  unsigned int newLen = len + length;
+  //the source can be part of this string
+  const char *base = buffer();
+  bool selfCopy = cstr >= base && cstr < base + len;
+  size_t offset = cstr - base;
+  if (!reserve(newLen)) {
+    return false;
+  }
+  if (selfCopy) {
+    cstr = buffer() + offset;
+  }
+  memmove(wbuffer() + len, cstr, length);
+  len = newLen;
+  wbuffer()[len] = 0;
+  return true;
+}
+
+bool String::concat(const String &str) {
+  return concat(str.buffer(), str.len);
+}
+
+bool String::concat(const char *cstr) {
+  return cstr ? concat(cstr, strlen(cstr)) : false;
+}
+
+bool String::concat(const __FlashStringHelper *str) {
+  return concat(reinterpret_cast<const char *>(str));
+}
+
+bool String::concat(char c) {
+  return concat(&c, 1);
+}
+
+bool String::concatNumber(const char *format, ...) {
+  char digits[64];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(digits, sizeof(digits), format, args);
+  va_end(args);
+  return length >= 0 && concat(digits, length);
+}
+
+bool String::concat(unsigned char value) { return concatNumber("%u", static_cast<unsigned int>(value)); }
+bool String::concat(int value) { return concatNumber("%d", value); }
+bool String::concat(unsigned int value) { return concatNumber("%u", value); }
+bool String::concat(long value) { return concatNumber("%ld", value); }
+bool String::concat(unsigned long value) { return concatNumber("%lu", value); }
+bool String::concat(long long value) { return concatNumber("%lld", value); }
+bool String::concat(unsigned long long value) { return concatNumber("%llu", value); }
+bool String::concat(float value) { return concatNumber("%.2f", static_cast<double>(value)); }
+bool String::concat(double value) { return concatNumber("%.2f", value); }
+
+int String::compareTo(const String &s) const {
+  return strcmp(buffer(), s.buffer());
+}
+
+bool String::equals(const String &s) const {
+  return len == s.len && memcmp(buffer(), s.buffer(), len) == 0;
+}
+
+bool String::equals(const char *cstr) const {
+  return cstr ? strcmp(buffer(), cstr) == 0 : len == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  if (len != s.len) {
+    return false;
+  }
+  for (unsigned int i = 0; i < len; i++) {
+    if (tolower(static_cast<unsigned char>(buffer()[i])) != tolower(static_cast<unsigned char>(s.buffer()[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return prefix.len <= len && memcmp(buffer(), prefix.buffer(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return suffix.len <= len && memcmp(buffer() + len - suffix.len, suffix.buffer(), suffix.len) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < len ? buffer()[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < len) {
+    wbuffer()[index] = c;
+  }
+}
+
+char String::operator[](unsigned int index) const {
+  return charAt(index);
+}
+
+char &String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= len) {
+    dummy = 0;
+    return dummy;
+  }
+  return wbuffer()[index];
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len) {
+    return -1;
+  }
+  const char *found = static_cast<const char *>(memchr(buffer() + fromIndex, ch, len - fromIndex));
+  return found ? found - buffer() : -1;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+  if (fromIndex > len) {
+    return -1;
+  }
+  const char *found = strstr(buffer() + fromIndex, str.buffer());
+  return found ? found - buffer() : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+  const char *found = strrchr(buffer(), ch);
+  return found ? found - buffer() : -1;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int temp = endIndex;
+    endIndex = beginIndex;
+    beginIndex = temp;
+  }
+  if (beginIndex >= len) {
+    return String();
+  }
+  if (endIndex > len) {
+    endIndex = len;
+  }
+  return String(buffer() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  for (unsigned int i = 0; i < len; i++) {
+    if (wbuffer()[i] == find) {
+      wbuffer()[i] = replace;
+    }
+  }
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (find.len == 0) {
+    return;
+  }
+  String result;
+  unsigned int from = 0;
+  int found;
+  while ((found = indexOf(find, from)) >= 0) {
+    result.concat(buffer() + from, found - from);
+    result.concat(replace);
+    from = found + find.len;
+  }
+  result.concat(buffer() + from, len - from);
+  *this = static_cast<String &&>(result);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, static_cast<unsigned int>(-1));
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len || count == 0) {
+    return;
+  }
+  if (count > len - index) {
+    count = len - index;
+  }
+  memmove(wbuffer() + index, buffer() + index + count, len - index - count);
+  len -= count;
+  wbuffer()[len] = 0;
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++) {
+    wbuffer()[i] = tolower(static_cast<unsigned char>(wbuffer()[i]));
+  }
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++) {
+    wbuffer()[i] = toupper(static_cast<unsigned char>(wbuffer()[i]));
+  }
+}
+
+void String::trim() {
+  unsigned int first = 0;
+  while (first < len && isspace(static_cast<unsigned char>(buffer()[first]))) {
+    first++;
+  }
+  unsigned int last = len;
+  while (last > first && isspace(static_cast<unsigned char>(buffer()[last - 1]))) {
+    last--;
+  }
+  if (first > 0) {
+    memmove(wbuffer(), buffer() + first, last - first);
+  }
+  len = last - first;
+  wbuffer()[len] = 0;
+}
+
+long String::toInt() const {
+  return atol(buffer());
+}
+
+float String::toFloat() const {
+  return atof(buffer());
+}
+
+double String::toDouble() const {
+  return atof(buffer());
+}
+
+String operator+(const char *lhs, const String &rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(char lhs, const String &rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const __FlashStringHelper *lhs, const String &rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
@@ -0,0 +1,176 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_WSTRING_H_
+#define HOST_WSTRING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Host build stand-in for the ESP8266 core's String class.
+// Only the parts the sketch uses are here, but the buffer handling follows the
+// core (11 characters inline, heap buffers grown with realloc() rounded up to
+// 16 bytes, moves steal the buffer) so the allocation counts seen on the host
+// are a fair picture of what happens on the device.
+//
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
+
+class String {
+public:
+  String();
+  String(const char *cstr);
+  String(const char *cstr, unsigned int length);
+  String(const String &str);
+  String(String &&rval) noexcept;
+  String(const __FlashStringHelper *str);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+  ~String();
+
+  String &operator=(const String &rhs);
+  String &operator=(String &&rval) noexcept;
+  String &operator=(const char *cstr);
+  String &operator=(const __FlashStringHelper *str);
+  String &operator=(char c);
+
+  bool reserve(unsigned int size);
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  const char *c_str() const { return buffer(); }
+  char *begin() { return wbuffer(); }
+  char *end() { return wbuffer() + len; }
+  const char *begin() const { return buffer(); }
+  const char *end() const { return buffer() + len; }
+
+  bool concat(const String &str);
+  bool concat(const char *cstr);
+  bool concat(const char *cstr, unsigned int length);
+  bool concat(const __FlashStringHelper *str);
+  bool concat(char c);
+  bool concat(unsigned char value);
+  bool concat(int value);
+  bool concat(unsigned int value);
+  bool concat(long value);
+  bool concat(unsigned long value);
+  bool concat(long long value);
+  bool concat(unsigned long long value);
+  bool concat(float value);
+  bool concat(double value);
+
+  template <typename T>
+  String &operator+=(const T &rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  int compareTo(const String &s) const;
+  bool equals(const String &s) const;
+  bool equals(const char *cstr) const;
+  bool equalsIgnoreCase(const String &s) const;
+  bool startsWith(const String &prefix) const;
+  bool endsWith(const String &suffix) const;
+  bool operator==(const String &rhs) const { return equals(rhs); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &rhs) const { return !equals(rhs); }
+  bool operator!=(const char *cstr) const { return !equals(cstr); }
+  bool operator<(const String &rhs) const { return compareTo(rhs) < 0; }
+
+  char charAt(unsigned int index) const;
+  void setCharAt(unsigned int index, char c);
+  char operator[](unsigned int index) const;
+  char &operator[](unsigned int index);
+
+  int indexOf(char ch, unsigned int fromIndex = 0) const;
+  int indexOf(const String &str, unsigned int fromIndex = 0) const;
+  int lastIndexOf(char ch) const;
+  String substring(unsigned int beginIndex) const { return substring(beginIndex, len); }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replace);
+  void replace(const String &find, const String &replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+private:
+  enum { SSO_CAPACITY = 11 };
+
+  const char *buffer() const { return heap ? heap : sso; }
+  char *wbuffer() { return heap ? heap : sso; }
+  unsigned int capacity() const { return heap ? heapCapacity : SSO_CAPACITY; }
+  void invalidate();
+  bool changeBuffer(unsigned int maxStrLen);
+  String &copy(const char *cstr, unsigned int length);
+  void move(String &rhs) noexcept;
+  bool concatNumber(const char *format, ...);
+
+  char sso[SSO_CAPACITY + 1];
+  char *heap;
+  unsigned int heapCapacity;
+  unsigned int len;
+};
+
+//
+// Concatenation. Like the core, a temporary on the left is extended in place
+// and anything else is copied first.
+//
+template <typename T>
+String operator+(const String &lhs, const T &rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+template <typename T>
+String operator+(String &&lhs, const T &rhs) {
+  lhs.concat(rhs);
+  return static_cast<String &&>(lhs);
+}
+
+String operator+(const char *lhs, const String &rhs);
+String operator+(char lhs, const String &rhs);
+String operator+(const __FlashStringHelper *lhs, const String &rhs);
+
+inline bool operator==(const char *lhs, const String &rhs) {
+  return rhs.equals(lhs);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <chrono>
+#include <cstdlib>
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <coredecls.h>
+
+#include "allocCounter.hpp"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+//nominal free heap on a staConfig boot, before the web pages are set up
+#define HOST_FREE_HEAP 45000
+
+static std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+  (void)ms;
+}
+
+void yield() {}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  static const bool enabled = getenv("SERIAL_LOG") != nullptr;
+  if (!enabled) {
+    return size;
+  }
+  return fwrite(buffer, 1, size, stderr);
+}
+
+size_t Print::printf(const char *format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  return write(reinterpret_cast<const uint8_t *>(text), std::min<size_t>(length, sizeof(text) - 1));
+}
+
+uint32_t EspClass::getFreeHeap() {
+  int64_t freeHeap = HOST_FREE_HEAP - allocSnapshot().liveBytes;
+  return freeHeap > 0 ? freeHeap : 0;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+  return getFreeHeap();
+}
+
+bool IPAddress::fromString(const char *text) {
+  uint16_t acc = 0;
+  uint8_t dots = 0;
+  uint8_t bytes[4] = { 0, 0, 0, 0 };
+
+  while (*text) {
+    char c = *text++;
+    if (c >= '0' && c <= '9') {
+      acc = acc * 10 + (c - '0');
+      if (acc > 255) {
+        return false;
+      }
+    } else if (c == '.') {
+      if (dots == 3) {
+        return false;
+      }
+      bytes[dots++] = acc;
+      acc = 0;
+    } else {
+      return false;
+    }
+  }
+  if (dots != 3) {
+    return false;
+  }
+  bytes[3] = acc;
+  *this = IPAddress(bytes[0], bytes[1], bytes[2], bytes[3]);
+  return true;
+}
+
+String IPAddress::toString() const {
+  return String((*this)[0]) + '.' + String((*this)[1]) + '.' + String((*this)[2]) + '.' + String((*this)[3]);
+}
+
+uint32_t crc32(const void *data, size_t length, uint32_t crc) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  while (length--) {
+    uint8_t c = *bytes++;
+    for (uint32_t i = 0x80; i > 0; i >>= 1) {
+      bool bit = crc & 0x80000000;
+      if (c & i) {
+        bit = !bit;
+      }
+      crc <<= 1;
+      if (bit) {
+        crc ^= 0x04c11db7;
+      }
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <cstdlib>
+#include <vector>
+
+#include "testing.hpp"
+
+struct testEntry {
+  const char *name;
+  testFunction function;
+};
+
+static std::vector<testEntry> &tests() {
+  static std::vector<testEntry> registered;
+  return registered;
+}
+
+static int failures;
+static std::mt19937 generator;
+
+testRegistration::testRegistration(const char *name, testFunction function) {
+  tests().push_back({ name, function });
+}
+
+void testFailed(const char *file, int line, const char *expression) {
+  printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+  failures++;
+}
+
+std::mt19937 &testRandom() {
+  return generator;
+}
+
+int main() {
+  const char *seedText = getenv("TEST_SEED");
+  unsigned long seed = seedText ? strtoul(seedText, nullptr, 0) : 20240101;
+  int failedTests = 0;
+
+  printf("seed %lu\n", seed);
+  for (const testEntry &test : tests()) {
+    int before = failures;
+    generator.seed(seed);
+    test.function();
+    if (failures != before) {
+      failedTests++;
+      printf("FAIL %s\n", test.name);
+    } else {
+      printf("ok   %s\n", test.name);
+    }
+  }
+  printf("%zu tests, %d failed\n", tests().size(), failedTests);
+  return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef HOST_TESTING_H_
+#define HOST_TESTING_H_
+
+#include <cstdio>
+#include <random>
+
+//
+// Minimal test runner for the host build.
+// TEST(name) defines a test that's run by testMain.cpp. CHECK() reports a
+// failure and carries on so one run shows everything that's wrong.
+// Randomised tests use testRandom(), which is seeded from TEST_SEED if set
+// so a failure can be reproduced.
+//
+
+typedef void (*testFunction)();
+
+struct testRegistration {
+  testRegistration(const char *name, testFunction function);
+};
+
+void testFailed(const char *file, int line, const char *expression);
+std::mt19937 &testRandom();
+
+#define TEST(name)                                           \
+  static void name();                                        \
+  static testRegistration name##Registration(#name, name);   \
+  static void name()
+
+#define CHECK(condition)                                     \
+  do {                                                       \
+    if (!(condition)) {                                      \
+      testFailed(__FILE__, __LINE__, #condition);            \
+    }                                                        \
+  } while (0)
+
+//For loops over random cases: report the failing case and stop the test
+#define REQUIRE(condition)                                   \
+  do {                                                       \
+    if (!(condition)) {                                      \
+      testFailed(__FILE__, __LINE__, #condition);            \
+      return;                                                \
+    }                                                        \
+  } while (0)
+
+#endif
@@ -0,0 +1,122 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <chrono>
+
+#include "allocCounter.hpp"
+#include "hostSketch.hpp"
+
+//
+// Microbenchmarks for building and serving the config page as the number of
+// config items grows. Times are for the host and only useful relative to each
+// other; the allocation counts follow the ESP8266 core's String and are a fair
+// guide to what the device does.
+//
+
+#define BENCH_MIN_MILLIS 50
+
+struct benchResult {
+  double nanosPerCall;
+  double allocationsPerCall;
+  double bytesPerCall;
+  int64_t peakBytes;
+};
+
+//
+// bench
+// Calls fn until BENCH_MIN_MILLIS have gone by and averages over the calls.
+//
+template <typename Fn>
+static benchResult bench(Fn fn) {
+  typedef std::chrono::steady_clock clock;
+  benchResult result;
+  uint64_t calls = 0;
+  //warm up so one time allocations don't count
+  fn();
+  allocScope scope;
+  clock::time_point start = clock::now();
+  clock::duration elapsed;
+  do {
+    fn();
+    calls++;
+    elapsed = clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(BENCH_MIN_MILLIS));
+  allocStats stats = scope.delta();
+  result.nanosPerCall = std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+  result.allocationsPerCall = static_cast<double>(stats.allocations) / calls;
+  result.bytesPerCall = static_cast<double>(stats.bytes) / calls;
+  result.peakBytes = stats.peakBytes;
+  return result;
+}
+
+static void printResult(size_t items, const char *name, const benchResult &result) {
+  printf("%5zu  %-26s %12.0f %10.1f %11.0f %9lld\n", items, name, result.nanosPerCall, result.allocationsPerCall,
+         result.bytesPerCall, static_cast<long long>(result.peakBytes));
+}
+
+//Items like the real ones: mostly text, the odd password
+static std::vector<configItemData> makeItems(size_t count) {
+  std::vector<configItemData> items;
+  for (size_t i = 0; i < count; i++) {
+    items.push_back({ String("Setting number ") + i, String("setting") + i, i % 7 == 2, 64, String() });
+  }
+  return items;
+}
+
+int main() {
+  static const size_t itemCounts[] = { 7, 14, 28, 56, 112 };
+
+  printf("%5s  %-26s %12s %10s %11s %9s\n", "items", "benchmark", "ns/call", "allocs", "bytes", "peak");
+  for (size_t count : itemCounts) {
+    configItems = configurationItems(makeItems(count));
+    loadBootConfig(nullptr);
+    AsyncWebServerRequest form;
+    for (size_t i = 0; i < count; i++) {
+      form.addParam(String("setting") + i, String("value of setting ") + i);
+    }
+    configItems.saveResponseValues(&form);
+    registerHtmlInterfaces();
+    String lastKey = String("setting") + (count - 1);
+
+    printResult(count, "processor(last item)", bench([&]() {
+      processor(lastKey);
+    }));
+    printResult(count, "processor(CONFIG_FIELDS)", bench([]() {
+      processor("CONFIG_FIELDS");
+    }));
+    printResult(count, "buildInputFormEntries", bench([]() {
+      String buffer;
+      configItems.buildInputFormEntries(buffer);
+    }));
+    size_t pageBytes = 0;
+    printResult(count, "GET / (static, gzip)", bench([]() {
+      request(HTTP_GET, "/");
+    }));
+    printResult(count, "GET /fields.htm (render)", bench([&]() {
+      std::unique_ptr<AsyncWebServerRequest> page = request(HTTP_GET, "/fields.htm");
+      pageBytes = page->response()->content.size();
+    }));
+    printf("%5zu  %-26s %12zu\n", count, "page size (bytes)", pageBytes);
+  }
+  return 0;
+}
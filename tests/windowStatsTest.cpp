@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#include <Arduino.h>
+
+#include "testing.hpp"
+#include "windowStats.hpp"
+
+//
+// Tests for the high rate mode window statistics.
+//
+
+TEST(stddevOfSmallSpread) {
+  windowStats stats;
+  stats.reset();
+  for (int i = 0; i < 600; i++) {
+    stats.add(i % 2 ? 2346 : 2345);
+  }
+  CHECK(stats.mean() == 2345);
+  CHECK(stats.stddev() == 5);  //0.005
+}
+
+TEST(stddevKnownValues) {
+  static const int32_t values[] = { 200, 400, 400, 400, 500, 500, 700, 900 };
+  windowStats stats;
+  stats.reset();
+  CHECK(stats.stddev() == 0);
+  for (int32_t value : values) {
+    stats.add(value);
+  }
+  CHECK(stats.mean() == 500);
+  CHECK(stats.stddev() == 2000);  //2.000
+  CHECK(stats.minValue == 200 && stats.maxValue == 900);
+
+  stats.reset();
+  for (int i = 0; i < 100; i++) {
+    stats.add(-1234);
+  }
+  CHECK(stats.stddev() == 0);
+}
+
+//An hour at 10Hz swinging across the whole range of the sensor
+TEST(stddevFullScaleWindow) {
+  windowStats stats;
+  stats.reset();
+  for (int i = 0; i < 36000; i++) {
+    stats.add(i % 2 ? 12500 : -4500);
+  }
+  CHECK(stats.mean() == 4000);
+  CHECK(stats.stddev() == 85000);  //85.000
+}
+
+TEST(stddevMatchesFloatingPoint) {
+  std::mt19937 &random = testRandom();
+  for (int iteration = 0; iteration < 200; iteration++) {
+    windowStats stats;
+    stats.reset();
+    int32_t centre = std::uniform_int_distribution<int32_t>(-4000, 12000)(random);
+    int32_t spread = std::uniform_int_distribution<int32_t>(0, 500)(random);
+    int count = std::uniform_int_distribution<int>(2, 3000)(random);
+    double sum = 0;
+    double sumSquares = 0;
+    for (int i = 0; i < count; i++) {
+      int32_t value = centre + std::uniform_int_distribution<int32_t>(-spread, spread)(random);
+      stats.add(value);
+      sum += value;
+      sumSquares += static_cast<double>(value) * value;
+    }
+    double mean = sum / count;
+    double expected = sqrt(std::max(0.0, sumSquares / count - mean * mean)) * 10;
+    REQUIRE(fabs(stats.stddev() - expected) <= 1.0);
+  }
+}
+
+TEST(isqrtRounds) {
+  CHECK(windowStats::isqrtRounded(0) == 0);
+  CHECK(windowStats::isqrtRounded(2) == 1);
+  CHECK(windowStats::isqrtRounded(3) == 2);
+  CHECK(windowStats::isqrtRounded(25) == 5);
+  CHECK(windowStats::isqrtRounded(30) == 5);
+  CHECK(windowStats::isqrtRounded(31) == 6);
+  CHECK(windowStats::isqrt(UINT64_MAX) == UINT32_MAX);
+}
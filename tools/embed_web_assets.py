@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2024 Matthew Lazarowitz
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+"""
+Embed the web UI into the firmware.
+
+Every file in web/ is minified and written to webAssets.hpp as a PROGMEM array.
+Files without %PLACEHOLDER% templates are also gzip compressed and get served
+with Content-Encoding: gzip. Template files have to stay uncompressed since the
+web server does the substitution on the plain text as it is sent.
+
+The CRCs of the unminified files are written out too, along with those of
+pages shipped before they were embedded. A LittleFS copy matching one of them
+is a stock page rather than a user's override and gets deleted at startup.
+
+Run from the sketch directory after changing anything in web/:
+    python3 tools/embed_web_assets.py
+"""
+
+import gzip
+import os
+import re
+import sys
+
+SKETCH_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEB_DIR = os.path.join(SKETCH_DIR, "web")
+OUTPUT = os.path.join(SKETCH_DIR, "webAssets.hpp")
+
+CONTENT_TYPES = {
+    ".htm": "text/html",
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+}
+
+TEMPLATE_RE = re.compile(rb"%[A-Za-z_][A-Za-z0-9_]*%")
+
+# Pages that used to be uploaded to LittleFS from data/, by the CRC of the file
+# with LF and with CRLF line endings. Keep these when the pages in web/ change.
+LEGACY_STOCK = [
+    ("/index.htm", 0x6799600c),  # data/index.htm, before the pages were embedded
+    ("/index.htm", 0xf5b3ee71),
+]
+
+
+def core_crc32(data):
+    """The ESP8266 core's crc32(): MSB first, polynomial 0x04c11db7, no final XOR."""
+    crc = 0xffffffff
+    for byte in data:
+        for bit in range(7, -1, -1):
+            top = (crc >> 31) ^ ((byte >> bit) & 1)
+            crc = (crc << 1) & 0xffffffff
+            if top:
+                crc ^= 0x04c11db7
+    return crc
+
+
+def minify(name, data):
+    ext = os.path.splitext(name)[1].lower()
+    if ext in (".htm", ".html"):
+        data = re.sub(rb"<!--.*?-->", b"", data, flags=re.S)
+        data = re.sub(rb">\s+<", b"><", data)
+        data = re.sub(rb"\s+", b" ", data)
+        return data.strip()
+    if ext == ".css":
+        data = re.sub(rb"/\*.*?\*/", b"", data, flags=re.S)
+        data = re.sub(rb"\s+", b" ", data)
+        data = re.sub(rb"\s*([{};:,])\s*", rb"\1", data)
+        return data.strip()
+    return data
+
+
+def c_name(name):
+    return "asset_" + re.sub(r"[^A-Za-z0-9]", "_", name)
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    entries = []
+    arrays = []
+    stock = list(LEGACY_STOCK)
+    for name in sorted(os.listdir(WEB_DIR)):
+        path = os.path.join(WEB_DIR, name)
+        if not os.path.isfile(path):
+            continue
+        ext = os.path.splitext(name)[1].lower()
+        content_type = CONTENT_TYPES.get(ext, "application/octet-stream")
+        with open(path, "rb") as f:
+            raw = f.read()
+        lf = raw.replace(b"\r\n", b"\n")
+        for variant in (lf, lf.replace(b"\n", b"\r\n")):
+            if ("/" + name, core_crc32(variant)) not in stock:
+                stock.append(("/" + name, core_crc32(variant)))
+        data = minify(name, raw)
+        is_template = TEMPLATE_RE.search(data) is not None
+        if not is_template:
+            # mtime=0 keeps the output the same from run to run
+            data = gzip.compress(data, compresslevel=9, mtime=0)
+        arrays.append("//%s: %d bytes -> %d bytes%s\nstatic const uint8_t %s[] PROGMEM = {\n%s\n};\n"
+                      % (name, len(raw), len(data), " (gzip)" if not is_template else "",
+                         c_name(name), c_array(data)))
+        entries.append('  { "/%s", "%s", %s, sizeof(%s), %s, %s },'
+                       % (name, content_type, c_name(name), c_name(name),
+                          "false" if is_template else "true", "true" if is_template else "false"))
+        print("%s: %d -> %d bytes%s" % (name, len(raw), len(data), " template" if is_template else " gzip"))
+
+    with open(OUTPUT, "w", newline="\n") as out:
+        out.write("//\n// Generated by tools/embed_web_assets.py from the files in web/. Do not edit.\n//\n")
+        out.write("#ifndef WEB_ASSETS_H_\n#define WEB_ASSETS_H_\n\n#include <Arduino.h>\n\n")
+        out.write("struct webAsset {\n  const char* path;\n  const char* contentType;\n"
+                  "  const uint8_t* data;\n  size_t length;\n  bool gzipped;\n  bool isTemplate;\n};\n\n")
+        out.write("\n".join(arrays))
+        out.write("\nstatic const webAsset webAssets[] = {\n%s\n};\n" % "\n".join(entries))
+        out.write("\n//CRCs of stock copies of the pages, see isStockCopy()\n")
+        out.write("struct stockAssetCrc {\n  const char* path;\n  uint32_t crc;\n};\n\n")
+        out.write("static const stockAssetCrc stockAssetCrcs[] = {\n%s\n};\n\n#endif\n"
+                  % "\n".join('  { "%s", 0x%08x },' % entry for entry in stock))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
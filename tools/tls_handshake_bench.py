@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2024 Matthew Lazarowitz
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+"""
+Measure the device's TLS MQTT handshake times, full and resumed.
+
+Brings up a TLS MQTT broker on a throw away self-signed certificate:
+mosquitto if it's installed, otherwise a minimal stand-in that does the TLS
+handshake, acknowledges the MQTT CONNECT and then swallows whatever the client
+sends. Session tickets are off so resumption uses session IDs, which is what
+BearSSL on the device offers. The certificate fingerprint and the address to
+put in the config page are printed, then the device's serial log is read and
+every "TLS MQTT connect ... in N millis" line is collected until --wakes
+connects have been seen. The medians for full handshakes and for connects
+that offered a saved session are what a wake pays.
+
+    python3 tools/tls_handshake_bench.py --serial /dev/ttyUSB0 --wakes 30
+    pio device monitor | python3 tools/tls_handshake_bench.py --log -
+    python3 tools/tls_handshake_bench.py --log capture.txt
+
+A log that was captured against another broker can be summarised on its own
+with --log FILE --no-broker.
+
+--host-check doesn't involve a device at all. It times CPython/OpenSSL
+handshakes against the broker from this machine, which only shows that the
+broker resumes sessions. Those times say nothing about the ESP8266.
+"""
+
+import argparse
+import os
+import re
+import shutil
+import socket
+import ssl
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+CONNECT_RE = re.compile(r"TLS MQTT connect (ok|failed) in (\d+) millis \((resume offered|full handshake)")
+
+
+def make_certificate(directory, key):
+    """Create a self-signed certificate, returning (certfile, keyfile)."""
+    certfile = os.path.join(directory, "broker.crt")
+    keyfile = os.path.join(directory, "broker.key")
+    if key.startswith("ec:"):
+        keyargs = ["-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:" + key[3:]]
+    else:
+        keyargs = ["-newkey", key]
+    subprocess.run(["openssl", "req", "-x509", "-nodes", "-days", "30", "-subj", "/CN=mqtt-bench",
+                    "-keyout", keyfile, "-out", certfile] + keyargs,
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return certfile, keyfile
+
+
+def fingerprint(certfile):
+    """SHA1 fingerprint of the certificate as colon separated hex."""
+    result = subprocess.run(["openssl", "x509", "-noout", "-fingerprint", "-sha1", "-in", certfile],
+                            check=True, capture_output=True, text=True)
+    return result.stdout.strip().split("=", 1)[1]
+
+
+def local_address():
+    """The address this machine uses to reach the LAN, for the device config."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        try:
+            sock.connect(("192.0.2.1", 9))  # TEST-NET, nothing is sent
+            return sock.getsockname()[0]
+        except OSError:
+            return "127.0.0.1"
+
+
+def wait_for_port(port, timeout=5.0):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            socket.create_connection(("127.0.0.1", port), timeout=0.2).close()
+            return True
+        except OSError:
+            time.sleep(0.05)
+    return False
+
+
+def start_mosquitto(directory, port, certfile, keyfile):
+    """Start mosquitto with a TLS listener, returning the process."""
+    config = os.path.join(directory, "mosquitto.conf")
+    with open(config, "w") as out:
+        out.write("listener %d\n" % port)
+        out.write("allow_anonymous true\n")
+        out.write("certfile %s\nkeyfile %s\n" % (certfile, keyfile))
+        out.write("tls_version tlsv1.2\n")
+    return subprocess.Popen(["mosquitto", "-c", config],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+class StandIn:
+    """TLS listener that answers CONNECT and PINGREQ and ignores everything else."""
+
+    def __init__(self, port, certfile, keyfile):
+        self.context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        self.context.maximum_version = ssl.TLSVersion.TLSv1_2
+        self.context.options |= ssl.OP_NO_TICKET
+        self.context.load_cert_chain(certfile, keyfile)
+        self.listener = socket.create_server(("", port))
+        self.handshakes = 0
+        self.resumed = 0
+        threading.Thread(target=self.accept_loop, daemon=True).start()
+
+    @staticmethod
+    def read_packet(tls):
+        header = tls.recv(1)
+        if not header:
+            return None
+        length, shift = 0, 0
+        while True:
+            byte = tls.recv(1)
+            if not byte:
+                return None
+            length |= (byte[0] & 0x7f) << shift
+            shift += 7
+            if not byte[0] & 0x80:
+                break
+        body = b""
+        while len(body) < length:
+            chunk = tls.recv(length - len(body))
+            if not chunk:
+                return None
+            body += chunk
+        return header[0] >> 4
+
+    def serve(self, conn):
+        try:
+            with self.context.wrap_socket(conn, server_side=True) as tls:
+                self.handshakes += 1
+                self.resumed += tls.session_reused
+                while True:
+                    packet = self.read_packet(tls)
+                    if packet is None:
+                        # a clean shutdown keeps the session resumable
+                        tls.unwrap()
+                        return
+                    if packet == 1:  # CONNECT -> CONNACK, accepted
+                        tls.sendall(b"\x20\x02\x00\x00")
+                    elif packet == 12:  # PINGREQ -> PINGRESP
+                        tls.sendall(b"\xd0\x00")
+        except (OSError, ssl.SSLError):
+            pass
+
+    def accept_loop(self):
+        while True:
+            try:
+                conn, _ = self.listener.accept()
+            except OSError:
+                return
+            threading.Thread(target=self.serve, args=(conn,), daemon=True).start()
+
+    def close(self):
+        self.listener.close()
+
+
+def device_lines(args):
+    """Lines of the device's serial log, from --serial or --log."""
+    if args.serial:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--serial needs pyserial (pip install pyserial), or pipe a monitor into --log -")
+        with serial.Serial(args.serial, args.baud, timeout=1) as port:
+            while True:
+                yield port.readline().decode("utf-8", "replace")
+    else:
+        stream = sys.stdin if args.log == "-" else open(args.log, errors="replace")
+        with stream:
+            yield from stream
+
+
+def collect_device_timings(args):
+    full, offered, failed = [], [], 0
+    for line in device_lines(args):
+        match = CONNECT_RE.search(line)
+        if not match:
+            continue
+        print(line.strip())
+        if match.group(1) == "failed":
+            failed += 1
+        elif match.group(3) == "full handshake":
+            full.append(int(match.group(2)))
+        else:
+            offered.append(int(match.group(2)))
+        if args.wakes and len(full) + len(offered) + failed >= args.wakes:
+            break
+    return full, offered, failed
+
+
+def summarize(name, times, unit="ms"):
+    if times:
+        print("%-16s n=%-4d median %8.1f %s  min %8.1f  max %8.1f" %
+              (name, len(times), statistics.median(times), unit, min(times), max(times)))
+    else:
+        print("%-16s none" % name)
+
+
+def host_check(host, port, iterations):
+    """Time OpenSSL handshakes from this machine. Only checks that the broker resumes."""
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.check_hostname = False
+    context.verify_mode = ssl.CERT_NONE
+
+    def handshake(session=None):
+        with socket.create_connection((host, port)) as sock:
+            start = time.perf_counter()
+            with context.wrap_socket(sock, server_hostname=host, session=session) as tls:
+                elapsed = (time.perf_counter() - start) * 1000.0
+                result = elapsed, tls.session, tls.session_reused
+                # OpenSSL drops a session from its cache if the connection isn't shut down cleanly
+                try:
+                    tls.unwrap()
+                except (OSError, ssl.SSLError):
+                    pass
+                return result
+
+    full = [handshake()[0] for _ in range(iterations)]
+    _, session, _ = handshake()
+    attempts = [handshake(session) for _ in range(iterations)]
+    resumed = [elapsed for elapsed, _, reused in attempts if reused]
+    print("host OpenSSL handshakes (not device timings):")
+    summarize("  full", full)
+    summarize("  resumed", resumed)
+    print("  broker resumed %d of %d offered sessions" % (len(resumed), iterations))
+    return len(resumed) == iterations
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument("--serial", help="serial port the device logs to")
+    source.add_argument("--log", help="device log file, - for stdin")
+    source.add_argument("--host-check", action="store_true",
+                        help="no device, only check the broker resumes sessions")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--wakes", type=int, default=30, help="device connects to collect, 0 for all")
+    parser.add_argument("--iterations", type=int, default=50, help="handshakes of each kind for --host-check")
+    parser.add_argument("--port", type=int, default=8883)
+    parser.add_argument("--key", default="rsa:2048", help="openssl key spec, e.g. rsa:2048 or ec:prime256v1")
+    parser.add_argument("--standin", action="store_true", help="use the stand-in even if mosquitto is installed")
+    parser.add_argument("--no-broker", action="store_true", help="only summarise the device log")
+    args = parser.parse_args()
+    if not (args.serial or args.log or args.host_check):
+        parser.error("give --serial or --log to time the device, or --host-check")
+
+    workdir = tempfile.mkdtemp(prefix="tlsbench")
+    broker = None
+    try:
+        if not args.no_broker:
+            certfile, keyfile = make_certificate(workdir, args.key)
+            if shutil.which("mosquitto") and not args.standin:
+                broker = start_mosquitto(workdir, args.port, certfile, keyfile)
+                print("broker: mosquitto, key %s" % args.key)
+            else:
+                broker = StandIn(args.port, certfile, keyfile)
+                print("broker: stand-in (mosquitto not used), key %s" % args.key)
+            if not wait_for_port(args.port):
+                sys.exit("broker didn't start")
+            print("config page: MqttIp %s:%d" % (local_address(), args.port))
+            print("config page: MqttTlsFingerprint %s" % fingerprint(certfile))
+
+        if args.host_check:
+            sys.exit(0 if host_check("127.0.0.1", args.port, args.iterations) else 1)
+
+        print("waiting for the device...")
+        full, offered, failed = collect_device_timings(args)
+        print("device TLS MQTT connect times:")
+        summarize("  full handshake", full)
+        summarize("  resume offered", offered)
+        if full and offered:
+            print("  resume offered/full median: %.2f" % (statistics.median(offered) / statistics.median(full)))
+        if failed:
+            print("  %d connects failed" % failed)
+        if isinstance(broker, StandIn):
+            print("  broker side: %d of %d handshakes resumed" % (broker.resumed, broker.handshakes))
+    finally:
+        if isinstance(broker, subprocess.Popen):
+            broker.terminate()
+            broker.wait()
+        elif broker is not None:
+            broker.close()
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+//
+// Generated by tools/embed_web_assets.py from the files in web/. Do not edit.
+//
+#ifndef WEB_ASSETS_H_
+#define WEB_ASSETS_H_
+
+#include <Arduino.h>
+
+struct webAsset {
+  const char* path;
+  const char* contentType;
+  const uint8_t* data;
+  size_t length;
+  bool gzipped;
+  bool isTemplate;
+};
+
+//fields.htm: 434 bytes -> 308 bytes
+static const uint8_t asset_fields_htm[] PROGMEM = {
+  0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3d, 0x22, 0x63, 0x6f,
+  0x6e, 0x66, 0x69, 0x67, 0x22, 0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d, 0x22, 0x70, 0x6f,
+  0x73, 0x74, 0x22, 0x20, 0x61, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2d, 0x63, 0x68, 0x61, 0x72, 0x73,
+  0x65, 0x74, 0x3d, 0x22, 0x75, 0x74, 0x66, 0x2d, 0x38, 0x22, 0x3e, 0x3c, 0x74, 0x61, 0x62, 0x6c,
+  0x65, 0x3e, 0x20, 0x25, 0x43, 0x4f, 0x4e, 0x46, 0x49, 0x47, 0x5f, 0x46, 0x49, 0x45, 0x4c, 0x44,
+  0x53, 0x25, 0x20, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75,
+  0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20,
+  0x76, 0x61, 0x6c, 0x75, 0x65, 0x3d, 0x22, 0x53, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x3e, 0x3c,
+  0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e, 0x20, 0x26, 0x6e, 0x62, 0x73, 0x70, 0x20, 0x26, 0x6e, 0x62,
+  0x73, 0x70, 0x20, 0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3d,
+  0x22, 0x73, 0x61, 0x76, 0x65, 0x22, 0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d, 0x22, 0x70,
+  0x6f, 0x73, 0x74, 0x22, 0x3e, 0x3c, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x3c, 0x74, 0x72, 0x3e,
+  0x3c, 0x74, 0x64, 0x3e, 0x54, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x73, 0x61, 0x76, 0x65, 0x64, 0x3c,
+  0x74, 0x64, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x20, 0x25, 0x52, 0x45, 0x50, 0x4f, 0x52, 0x54, 0x5f,
+  0x46, 0x49, 0x45, 0x4c, 0x44, 0x53, 0x25, 0x20, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e,
+  0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x73, 0x75, 0x62,
+  0x6d, 0x69, 0x74, 0x22, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x3d, 0x22, 0x53, 0x61, 0x76, 0x65,
+  0x22, 0x3e, 0x3c, 0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e, 0x20, 0x25, 0x43, 0x4f, 0x4e, 0x46, 0x49,
+  0x47, 0x5f, 0x53, 0x41, 0x56, 0x45, 0x44, 0x25, 0x20, 0x25, 0x46, 0x4f, 0x52, 0x4d, 0x41, 0x54,
+  0x5f, 0x46, 0x53, 0x25,
+};
+
+//index.htm: 810 bytes -> 359 bytes (gzip)
+static const uint8_t asset_index_htm[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x52, 0x3b, 0x4f, 0xc3, 0x30,
+  0x10, 0xfe, 0x2b, 0x87, 0xa7, 0x56, 0xa2, 0x89, 0x58, 0xc1, 0xc9, 0x40, 0x41, 0x02, 0x09, 0x04,
+  0x03, 0x0b, 0xa3, 0x6b, 0x5f, 0x9a, 0x13, 0xc9, 0x39, 0xb2, 0x2f, 0x2d, 0x15, 0xe2, 0xbf, 0x63,
+  0x37, 0xb4, 0x45, 0x82, 0x85, 0xc5, 0xb2, 0x7d, 0xf7, 0x3d, 0xee, 0xa1, 0xcf, 0x6e, 0x9e, 0x96,
+  0x2f, 0xaf, 0xcf, 0xb7, 0x70, 0xf7, 0xf2, 0xf8, 0x50, 0xeb, 0x56, 0xfa, 0x2e, 0x9d, 0x68, 0x5c,
+  0xad, 0x85, 0xa4, 0xc3, 0x7a, 0xe9, 0xb9, 0xa1, 0xf5, 0x18, 0x10, 0x18, 0x65, 0xeb, 0xc3, 0x1b,
+  0x44, 0x14, 0x21, 0x5e, 0x47, 0x5d, 0x4e, 0x19, 0xba, 0x47, 0x31, 0xc0, 0xa6, 0xc7, 0x4a, 0x6d,
+  0x08, 0xb7, 0x83, 0x0f, 0xa2, 0xc0, 0x7a, 0x16, 0x64, 0xa9, 0xd4, 0x96, 0x9c, 0xb4, 0x95, 0xc3,
+  0x0d, 0x59, 0x5c, 0xec, 0x1f, 0xe7, 0x40, 0x4c, 0x42, 0xa6, 0x5b, 0x44, 0x6b, 0x3a, 0xac, 0x2e,
+  0x54, 0xad, 0xcb, 0x49, 0x73, 0xe5, 0xdd, 0xae, 0xd6, 0x8e, 0x36, 0x40, 0xae, 0x52, 0x0d, 0x61,
+  0xe7, 0x62, 0x8a, 0xb2, 0x8f, 0x36, 0xd0, 0x20, 0xb5, 0x36, 0xd0, 0x06, 0x6c, 0x0e, 0xa1, 0x22,
+  0xf9, 0x55, 0x47, 0x8b, 0x46, 0xc8, 0xb3, 0x2e, 0x4d, 0x62, 0x3b, 0x01, 0xca, 0x44, 0x56, 0xeb,
+  0xc6, 0x87, 0x1e, 0x8c, 0xcd, 0x09, 0x95, 0x0a, 0x98, 0x4a, 0x50, 0x90, 0x6c, 0xb7, 0x3e, 0xa9,
+  0x0c, 0x3e, 0x4a, 0xd2, 0x20, 0x1e, 0x46, 0x01, 0xd9, 0x0d, 0xa9, 0x8c, 0x38, 0xae, 0x7a, 0x4a,
+  0x29, 0x1b, 0xd3, 0x8d, 0xe9, 0xb9, 0xec, 0xd0, 0x04, 0x98, 0x64, 0xb2, 0xd7, 0xcc, 0xf6, 0x8b,
+  0x73, 0xe5, 0xfd, 0xbf, 0x48, 0x27, 0x04, 0x4c, 0x8d, 0x39, 0xb1, 0x7e, 0xfb, 0x86, 0x06, 0xc5,
+  0xb6, 0xb3, 0x9f, 0x75, 0x9e, 0xc3, 0x07, 0x58, 0x63, 0x5b, 0xbc, 0x04, 0xc5, 0x7e, 0x11, 0xc5,
+  0x07, 0x54, 0xf0, 0x39, 0x87, 0x42, 0x5a, 0xe4, 0x59, 0x33, 0xf2, 0xde, 0x0b, 0xcc, 0x52, 0x7d,
+  0x83, 0xe7, 0x88, 0xf3, 0x04, 0x08, 0x28, 0x63, 0x60, 0x38, 0x7c, 0x15, 0x82, 0xef, 0x32, 0x9b,
+  0x5f, 0xfd, 0x05, 0xcb, 0xa1, 0x0c, 0x71, 0xde, 0x8e, 0x7d, 0x1a, 0x5d, 0xb1, 0x46, 0xb9, 0xed,
+  0x30, 0x5f, 0xaf, 0x77, 0xf7, 0xee, 0xe0, 0x45, 0xcd, 0x0b, 0x62, 0xc6, 0x90, 0x17, 0x06, 0x2a,
+  0xc8, 0xa8, 0x4c, 0x77, 0x05, 0xba, 0x3c, 0xf6, 0x7c, 0x1a, 0x63, 0xb9, 0xdf, 0xa6, 0x2f, 0x0e,
+  0x98, 0x10, 0xe8, 0x63, 0x02, 0x00, 0x00,
+};
+
+static const webAsset webAssets[] = {
+  { "/fields.htm", "text/html", asset_fields_htm, sizeof(asset_fields_htm), false, true },
+  { "/index.htm", "text/html", asset_index_htm, sizeof(asset_index_htm), true, false },
+};
+
+//CRCs of stock copies of the pages, see isStockCopy()
+struct stockAssetCrc {
+  const char* path;
+  uint32_t crc;
+};
+
+static const stockAssetCrc stockAssetCrcs[] = {
+  { "/index.htm", 0x6799600c },
+  { "/index.htm", 0xf5b3ee71 },
+  { "/fields.htm", 0x84fa7ef8 },
+  { "/fields.htm", 0x03366c1a },
+  { "/index.htm", 0x916465c0 },
+  { "/index.htm", 0xd4814481 },
+};
+
+#endif
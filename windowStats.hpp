@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2024 Matthew Lazarowitz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**/
+#ifndef WINDOW_STATS_H_
+#define WINDOW_STATS_H_
+
+#include <Arduino.h>
+
+//
+// windowStats
+// Running statistics for one quantity over a window.
+// Values are in hundredths. The sum of squares is kept in 64 bits; a full
+// scale value squared is ~1.6e8 so even an hour at 10Hz stays well in range.
+//
+struct windowStats {
+  int32_t minValue;
+  int32_t maxValue;
+  int64_t sum;
+  uint64_t sumSquares;
+  uint32_t count;
+
+  void reset() {
+    minValue = INT32_MAX;
+    maxValue = INT32_MIN;
+    sum = 0;
+    sumSquares = 0;
+    count = 0;
+  }
+
+  void add(int32_t value) {
+    minValue = min(minValue, value);
+    maxValue = max(maxValue, value);
+    sum += value;
+    sumSquares += static_cast<uint64_t>(static_cast<int64_t>(value) * value);
+    count++;
+  }
+
+  int32_t mean() const {
+    return count == 0 ? 0 : static_cast<int32_t>(sum / static_cast<int64_t>(count));
+  }
+
+  //
+  // stddev
+  // Population standard deviation in thousandths, one digit finer than the
+  // samples so a window that only moves by a count or two still shows up.
+  // The variance is (n*sumSquares - sum*sum)/(n*n), done on the exact sums so
+  // nothing is truncated before the subtraction. For an hour at 10Hz of full
+  // scale values the numerator is below 1e17, so scaling it by 100 for the
+  // extra digit still fits in 64 bits.
+  //
+  uint32_t stddev() const {
+    if (count < 2) {
+      return 0;
+    }
+    int64_t n = count;
+    int64_t numerator = n * static_cast<int64_t>(sumSquares) - sum * sum;
+    if (numerator <= 0) {
+      return 0;
+    }
+    uint64_t variance = static_cast<uint64_t>(numerator) * 100 / static_cast<uint64_t>(n * n);
+    return isqrtRounded(variance);
+  }
+
+  static uint32_t isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > value) {
+      bit >>= 2;
+    }
+    while (bit != 0) {
+      if (value >= root + bit) {
+        value -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+  }
+
+  //square root rounded to the nearest whole number: (r + 0.5)^2 = r^2 + r + 0.25
+  static uint32_t isqrtRounded(uint64_t value) {
+    uint64_t root = isqrt(value);
+    return value - root * root > root ? root + 1 : root;
+  }
+};
+
+#endif